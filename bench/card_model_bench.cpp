@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include "positions.h"
+
+static void BM_Cards_normalize(benchmark::State &state) {
+  const auto &positions = sampled_positions();
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Position &p = positions[i++ % positions.size()];
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      benchmark::DoNotOptimize(p.game.hand(seat).normalize(p.removed));
+    }
+  }
+}
+BENCHMARK(BM_Cards_normalize);
+
+static void BM_Cards_prune_equivalent(benchmark::State &state) {
+  const auto &positions = sampled_positions();
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Position &p     = positions[i++ % positions.size()];
+    Cards           plays = p.game.valid_plays_all();
+    benchmark::DoNotOptimize(plays.prune_equivalent(p.removed));
+  }
+}
+BENCHMARK(BM_Cards_prune_equivalent);
+
+static void BM_Cards_normalize_wbr(benchmark::State &state) {
+  const auto &positions = sampled_positions();
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Position &p = positions[i++ % positions.size()];
+    benchmark::DoNotOptimize(p.winners_by_rank.normalize_wbr(p.removed));
+  }
+}
+BENCHMARK(BM_Cards_normalize_wbr);
+
+static void BM_CardNormalizer_denormalize_wbr(benchmark::State &state) {
+  const auto        &positions = sampled_positions();
+  std::vector<Cards> normalized;
+  for (const Position &p : positions) {
+    normalized.push_back(p.game.normalize_wbr(p.winners_by_rank));
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    std::size_t j = i++ % positions.size();
+    benchmark::DoNotOptimize(positions[j].game.denormalize_wbr(normalized[j]));
+  }
+}
+BENCHMARK(BM_CardNormalizer_denormalize_wbr);
+
+static void BM_Cards_lowest_equivalent(benchmark::State &state) {
+  const auto &positions = sampled_positions();
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Position &p    = positions[i++ % positions.size()];
+    Cards           hand = p.game.hand(p.game.next_seat());
+    for (Card c : hand.high_to_low()) {
+      benchmark::DoNotOptimize(hand.lowest_equivalent(c, p.removed));
+    }
+  }
+}
+BENCHMARK(BM_Cards_lowest_equivalent);
@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+
+#include "fast_tricks.h"
+#include "positions.h"
+
+static void BM_estimate_fast_tricks(benchmark::State &state) {
+  // Fast tricks are only estimated at the start of a trick.
+  std::vector<Game> games;
+  for (const Position &p : sampled_positions()) {
+    if (p.game.start_of_trick()) {
+      games.push_back(p.game);
+    }
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Game &g = games[i++ % games.size()];
+    int         fast_tricks;
+    Cards       winners_by_rank;
+    estimate_fast_tricks(
+        g.hands(), g.next_seat(), g.trump_suit(), fast_tricks, winners_by_rank
+    );
+    benchmark::DoNotOptimize(fast_tricks);
+    benchmark::DoNotOptimize(winners_by_rank);
+  }
+}
+BENCHMARK(BM_estimate_fast_tricks);
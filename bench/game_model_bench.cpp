@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include "play_order.h"
+#include "positions.h"
+
+static void BM_Trick_winners_by_rank(benchmark::State &state) {
+  std::vector<const Position *> completed;
+  for (const Position &p : sampled_positions()) {
+    if (p.game.tricks_taken() > 0) {
+      completed.push_back(&p);
+    }
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Game &g = completed[i++ % completed.size()]->game;
+    benchmark::DoNotOptimize(g.last_trick().winners_by_rank(g.hands()));
+  }
+}
+BENCHMARK(BM_Trick_winners_by_rank);
+
+// Plays and unplays the solver's first choice of play at each position.
+static void BM_Game_play_unplay(benchmark::State &state) {
+  std::vector<Game> games;
+  std::vector<Card> plays;
+  for (const Position &p : sampled_positions()) {
+    PlayOrder order;
+    order_plays(p.game, order);
+    games.push_back(p.game);
+    plays.push_back(*order.begin());
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    std::size_t j = i++ % games.size();
+    games[j].play(plays[j]);
+    games[j].unplay();
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_Game_play_unplay);
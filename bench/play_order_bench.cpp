@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+
+#include "play_order.h"
+#include "positions.h"
+
+static void BM_order_plays(benchmark::State &state) {
+  const auto &positions = sampled_positions();
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    PlayOrder order;
+    order_plays(positions[i++ % positions.size()].game, order);
+    benchmark::DoNotOptimize(order);
+  }
+}
+BENCHMARK(BM_order_plays);
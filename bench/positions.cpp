@@ -0,0 +1,88 @@
+#include <sstream>
+#include <string>
+
+#include "play_order.h"
+#include "positions.h"
+#include "random.h"
+#include "solver.h"
+
+// Cards per hand in the deals solved. Traces of full deals are too large to
+// sample from quickly.
+constexpr int CARDS_PER_HAND = 8;
+
+// Replays the tricks listed at the end of a trace line, returning false for
+// lines which do not start a trick.
+static bool replay_trace_line(const std::string &line, Game &game) {
+  std::istringstream iss(line);
+  std::string        lineno, tag, hands;
+  iss >> lineno >> tag >> hands;
+  if (tag != "start" && tag != "tpn_cutoff" && tag != "ft_cutoff") {
+    return false;
+  }
+
+  // Skips alpha, beta, the tricks taken by NS, and the score (if any), then
+  // parses the tricks played (e.g., "A♠2♠3♠4♠ W5♣..."), skipping the
+  // winner of each trick.
+  std::string token, tricks;
+  while (iss >> token) {
+    bool number = token.find_first_not_of("-0123456789") == std::string::npos;
+    if (!number || !tricks.empty()) {
+      tricks += token;
+    }
+  }
+  Parser parser(tricks);
+  while (!parser.finished()) {
+    char c = parser.peek();
+    if (c == 'W' || c == 'N' || c == 'E' || c == 'S') {
+      parse_seat(parser);
+    } else {
+      game.play(Card(parser));
+    }
+  }
+  return true;
+}
+
+std::vector<Position> sample_positions(int num_positions) {
+  std::vector<Game> games;
+  for (int seed = 0; (int)games.size() < num_positions * 4; seed++) {
+    Game              deal = Random(seed).random_game(CARDS_PER_HAND);
+    Solver            solver(deal);
+    std::stringstream trace;
+    solver.enable_tracing(&trace);
+    solver.solve();
+
+    std::string line;
+    while (std::getline(trace, line)) {
+      Game game = deal;
+      if (replay_trace_line(line, game) && !game.finished()) {
+        games.push_back(game);
+      }
+    }
+  }
+
+  std::vector<Position> positions;
+  std::size_t           stride = games.size() / num_positions;
+  for (int i = 0; i < num_positions; i++) {
+    Game &game = games[i * stride];
+    for (int j = 0; j < i % 4; j++) {
+      PlayOrder order;
+      order_plays(game, order);
+      game.play(*order.begin());
+    }
+    Cards winners_by_rank;
+    if (game.tricks_taken() > 0) {
+      winners_by_rank = game.last_trick().winners_by_rank(game.hands());
+    }
+    positions.push_back({
+        .game            = game,
+        .removed         = game.hands().all_cards().complement(),
+        .winners_by_rank = winners_by_rank,
+    });
+  }
+  return positions;
+}
+
+const std::vector<Position> &sampled_positions() {
+  static const std::vector<Position> positions = sample_positions(1024);
+  return positions;
+}
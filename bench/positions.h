@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "game_model.h"
+
+// A position reached while solving a deal, with the cards removed from play,
+// and the winners by rank of the last trick played (if any).
+struct Position {
+  Game  game;
+  Cards removed;
+  Cards winners_by_rank;
+};
+
+// Samples positions from real solves, so that benchmarks see the positions
+// the solver spends its time on (e.g., mostly positions with few tricks
+// left), rather than uniformly random ones. Positions are taken evenly from
+// the start of each trick searched (as traced by the solver) while solving
+// random deals. Each position is then advanced by 0-3 cards, played in the
+// solver's preferred order, so that positions are spread across the trick.
+std::vector<Position> sample_positions(int num_positions);
+
+// A sample of positions shared by all benchmarks, sampled once.
+const std::vector<Position> &sampled_positions();
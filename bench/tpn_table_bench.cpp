@@ -0,0 +1,192 @@
+#include <array>
+#include <benchmark/benchmark.h>
+
+#include "positions.h"
+#include "random.h"
+#include "solver.h"
+#include "tpn_table.h"
+
+static Hands random_partition(Random &random, int cards_per_hand) {
+  Cards winners_by_rank;
+  for (Suit suit = FIRST_SUIT; suit <= LAST_SUIT; suit++) {
+    Card card = {random.random_rank(), suit};
+    winners_by_rank.add_all(Cards::higher_ranking(card));
+  }
+  Hands hands = random.random_deal(cards_per_hand);
+  return hands.make_partition(winners_by_rank);
+}
+
+// Looks up random hands in a bucket filled with the given number of random
+// partitions, using a window which rarely causes a cutoff, so that most
+// lookups read every entry. Reports entries read per second.
+static void BM_TpnBucket_lookup(benchmark::State &state) {
+  constexpr int CARDS_PER_HAND = 6;
+
+  Random           random(123);
+  TpnBucket::Arena arena;
+  TpnBucket        bucket(arena);
+  TpnBucket::Stats stats;
+
+  for (int i = 0; i < state.range(0); i++) {
+    int lower_bound = (int)(random.random_uniform() * CARDS_PER_HAND);
+    bucket.insert(
+        random_partition(random, CARDS_PER_HAND),
+        lower_bound,
+        CARDS_PER_HAND,
+        stats
+    );
+  }
+
+  std::vector<Hands> hands;
+  for (int i = 0; i < 1024; i++) {
+    hands.push_back(random.random_deal(CARDS_PER_HAND));
+  }
+
+  stats         = {};
+  std::size_t i = 0;
+  for (auto _ : state) {
+    int   score;
+    Cards winners_by_rank;
+    bool  found = bucket.lookup(
+        hands[i++ % hands.size()],
+        0,
+        CARDS_PER_HAND,
+        score,
+        winners_by_rank,
+        stats
+    );
+    benchmark::DoNotOptimize(found);
+  }
+
+  state.counters["entries"] = (double)bucket.entries();
+  state.counters["blocks"]  = (double)arena.size();
+  state.counters["reads"]   = benchmark::Counter(
+      (double)stats.lookup_reads, benchmark::Counter::kIsRate
+  );
+}
+BENCHMARK(BM_TpnBucket_lookup)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
+
+// Inserts random partitions into a bucket, emptying it once it reaches the
+// given number of entries.
+static void BM_TpnBucket_insert(benchmark::State &state) {
+  constexpr int CARDS_PER_HAND = 6;
+
+  Random             random(123);
+  std::vector<Hands> partitions;
+  std::vector<int>   lower_bounds;
+  for (int i = 0; i < 1024; i++) {
+    partitions.push_back(random_partition(random, CARDS_PER_HAND));
+    lower_bounds.push_back((int)(random.random_uniform() * CARDS_PER_HAND));
+  }
+
+  TpnBucket::Arena arena;
+  TpnBucket        bucket(arena);
+  TpnBucket::Stats stats;
+  std::size_t      i = 0;
+  for (auto _ : state) {
+    if (bucket.entries() >= state.range(0)) {
+      state.PauseTiming();
+      bucket.clear();
+      state.ResumeTiming();
+    }
+    std::size_t j = i++ % partitions.size();
+    bucket.insert(partitions[j], lower_bounds[j], CARDS_PER_HAND, stats);
+  }
+}
+BENCHMARK(BM_TpnBucket_insert)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
+
+// A sampled position at the start of a trick, with its solved result.
+struct SolvedPosition {
+  Game           game;
+  Solver::Result result;
+};
+
+static const std::vector<SolvedPosition> &solved_positions() {
+  static const std::vector<SolvedPosition> solved = []() {
+    std::vector<SolvedPosition> solved;
+    for (const Position &p : sampled_positions()) {
+      if (p.game.start_of_trick()) {
+        solved.push_back({p.game, Solver(p.game).solve()});
+      }
+    }
+    return solved;
+  }();
+  return solved;
+}
+
+// Makes the bucket key of each solved position, from its hands or as kept by
+// the game.
+static void BM_TpnBucketKey(benchmark::State &state) {
+  const auto &solved    = solved_positions();
+  bool        from_game = state.range(0);
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Game &g = solved[i++ % solved.size()].game;
+    if (from_game) {
+      benchmark::DoNotOptimize(TpnBucketKey(g));
+    } else {
+      benchmark::DoNotOptimize(TpnBucketKey(g.next_seat(), g.hands()));
+    }
+  }
+}
+BENCHMARK(BM_TpnBucketKey)->ArgName("from_game")->Arg(0)->Arg(1);
+
+// Entries are only shared between games with the same trump suit, so each
+// benchmark keeps a table per trump suit.
+using TpnTables = std::array<TpnTable, 5>;
+
+static void insert_solved(
+    TpnTables &tables, const SolvedPosition &s, TpnBucket::Stats &stats
+) {
+  int score = s.result.tricks_taken_by_ns;
+  tables[s.game.trump_suit()].insert(
+      s.game, s.result.winners_by_rank, score, score, stats
+  );
+}
+
+// Looks up the solved positions in tables holding their results, with a null
+// window around each score. Reports the fraction of lookups which hit.
+static void BM_TpnTable_lookup(benchmark::State &state) {
+  const auto      &solved = solved_positions();
+  TpnTables        tables;
+  TpnBucket::Stats stats;
+  for (const SolvedPosition &s : solved) {
+    insert_solved(tables, s, stats);
+  }
+
+  int64_t     hits = 0;
+  std::size_t i    = 0;
+  for (auto _ : state) {
+    const SolvedPosition &s     = solved[i++ % solved.size()];
+    int                   alpha = s.result.tricks_taken_by_ns;
+    int                   score;
+    Cards                 winners_by_rank;
+    hits += tables[s.game.trump_suit()].lookup(
+        s.game, alpha, alpha + 1, score, winners_by_rank, stats
+    );
+  }
+  state.counters["hit_rate"] =
+      (double)hits / std::max<int64_t>(state.iterations(), 1);
+}
+BENCHMARK(BM_TpnTable_lookup);
+
+// Inserts the solved positions' results, clearing the tables after each pass.
+static void BM_TpnTable_insert(benchmark::State &state) {
+  const auto      &solved = solved_positions();
+  TpnTables        tables;
+  TpnBucket::Stats stats;
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    if (i > 0 && i % solved.size() == 0) {
+      state.PauseTiming();
+      for (TpnTable &table : tables) {
+        table.clear();
+      }
+      state.ResumeTiming();
+    }
+    insert_solved(tables, solved[i++ % solved.size()], stats);
+  }
+}
+BENCHMARK(BM_TpnTable_insert);
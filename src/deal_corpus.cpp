@@ -0,0 +1,89 @@
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include "deal_corpus.h"
+
+static constexpr char     MAGIC[DealCorpus::HEADER_SIZE + 1] = "DUMDUM01";
+static constexpr int      MASK_BYTES                         = 7;
+static constexpr int      SEATS_OFFSET                       = 7;
+static constexpr int      TRUMP_SUIT_OFFSET                  = 20;
+static constexpr int      LEAD_SEAT_OFFSET                   = 21;
+static constexpr uint64_t ALL_CARDS                          = (1ull << 52) - 1;
+
+DealCorpus::DealCorpus(const std::string &path) : file_(path) {
+  if (file_.size() < HEADER_SIZE ||
+      std::memcmp(file_.data(), MAGIC, HEADER_SIZE) != 0) {
+    throw std::runtime_error(std::format("not a deal corpus: {}", path));
+  }
+  if ((file_.size() - HEADER_SIZE) % RECORD_SIZE != 0) {
+    throw std::runtime_error(std::format("truncated deal corpus: {}", path));
+  }
+  size_ = (file_.size() - HEADER_SIZE) / RECORD_SIZE;
+}
+
+Game DealCorpus::game(std::size_t index) const {
+  assert(index < size_);
+  return decode(file_.data() + HEADER_SIZE + index * RECORD_SIZE);
+}
+
+void DealCorpus::write_header(std::ostream &os) {
+  os.write(MAGIC, HEADER_SIZE);
+}
+
+void DealCorpus::write_game(std::ostream &os, const Game &game) {
+  uint8_t record[RECORD_SIZE];
+  encode(game, record);
+  os.write((const char *)record, RECORD_SIZE);
+}
+
+void DealCorpus::encode(const Game &game, uint8_t *record) {
+  if (game.started()) {
+    throw std::runtime_error("deal records must be at the start of play");
+  }
+
+  std::memset(record, 0, RECORD_SIZE);
+  uint64_t mask = game.hands().all_cards().bits();
+  for (int i = 0; i < MASK_BYTES; i++) {
+    record[i] = (uint8_t)(mask >> (8 * i));
+  }
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    for (Card c : game.hand(seat).low_to_high()) {
+      int bit = c.index();
+      record[SEATS_OFFSET + bit / 4] |= (uint8_t)(seat << (2 * (bit % 4)));
+    }
+  }
+  record[TRUMP_SUIT_OFFSET] = (uint8_t)game.trump_suit();
+  record[LEAD_SEAT_OFFSET]  = (uint8_t)game.lead_seat();
+}
+
+Game DealCorpus::decode(const uint8_t *record) {
+  uint64_t mask = 0;
+  for (int i = 0; i < MASK_BYTES; i++) {
+    mask |= (uint64_t)record[i] << (8 * i);
+  }
+  int trump_suit = record[TRUMP_SUIT_OFFSET];
+  int lead_seat  = record[LEAD_SEAT_OFFSET];
+  if (mask & ~ALL_CARDS || trump_suit > NO_TRUMP || lead_seat > LAST_SEAT) {
+    throw std::runtime_error("invalid deal record");
+  }
+
+  uint64_t hands[4] = {};
+  for (uint64_t bits = mask; bits; bits &= bits - 1) {
+    int bit  = std::countr_zero(bits);
+    int seat = (record[SEATS_OFFSET + bit / 4] >> (2 * (bit % 4))) & 0b11;
+    hands[seat] |= 1ull << bit;
+  }
+  return Game(
+      (Suit)trump_suit,
+      (Seat)lead_seat,
+      Hands(
+          Cards(hands[WEST]),
+          Cards(hands[NORTH]),
+          Cards(hands[EAST]),
+          Cards(hands[SOUTH])
+      )
+  );
+}
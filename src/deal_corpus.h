@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "game_model.h"
+#include "mapped_file.h"
+
+// A binary file of deals, as an 8-byte header followed by fixed-width records
+// which can be read by index, without parsing. Each record holds a game at
+// the start of play in 24 bytes:
+//
+//   bytes 0-6     a mask of the cards dealt, in the bit order of Cards
+//   bytes 7-19    the seat holding each card, two bits per card, in the same
+//                 order (and zero for cards not dealt)
+//   byte 20       the trump suit (or NO_TRUMP)
+//   byte 21       the seat on lead
+//   bytes 22-23   zero
+//
+// All values are little-endian.
+class DealCorpus {
+public:
+  static constexpr std::size_t HEADER_SIZE = 8;
+  static constexpr std::size_t RECORD_SIZE = 24;
+
+  // Maps a corpus into memory, throwing if the file is not a valid corpus.
+  explicit DealCorpus(const std::string &path);
+
+  std::size_t size() const { return size_; }
+  // Decodes a record, throwing if it does not hold a valid game.
+  Game game(std::size_t index) const;
+
+  static void write_header(std::ostream &os);
+  // Appends a record for a game, which must be at the start of play.
+  static void write_game(std::ostream &os, const Game &game);
+
+  static void encode(const Game &game, uint8_t *record);
+  static Game decode(const uint8_t *record);
+
+private:
+  MappedFile  file_;
+  std::size_t size_;
+};
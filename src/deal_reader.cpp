@@ -0,0 +1,315 @@
+#include <array>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+
+#include "deal_reader.h"
+
+DealFormat parse_deal_format(std::string_view str) {
+  if (str == "text") {
+    return FORMAT_TEXT;
+  } else if (str == "pbn") {
+    return FORMAT_PBN;
+  } else if (str == "lin") {
+    return FORMAT_LIN;
+  }
+  throw std::runtime_error(std::format("unknown deal format: {}", str));
+}
+
+DealReader::DealReader(std::string_view text, DealFormat format)
+    : remaining_(text),
+      format_(format) {}
+
+bool DealReader::next(std::optional<Game> &game) {
+  switch (format_) {
+  case FORMAT_TEXT:
+    return next_text(game);
+  case FORMAT_PBN:
+    return next_pbn(game);
+  case FORMAT_LIN:
+    return next_lin(game);
+  }
+  return false; // unreachable
+}
+
+static std::string_view trim(std::string_view s) {
+  while (!s.empty() && std::isspace((unsigned char)s.front())) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && std::isspace((unsigned char)s.back())) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// Reads the next line, without its line ending.
+bool DealReader::next_line(std::string_view &line) {
+  if (remaining_.empty()) {
+    return false;
+  }
+  std::size_t end = remaining_.find('\n');
+  if (end == std::string_view::npos) {
+    end = remaining_.size();
+  }
+  line = remaining_.substr(0, end);
+  remaining_.remove_prefix(std::min(end + 1, remaining_.size()));
+  if (line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+  return true;
+}
+
+bool DealReader::next_text(std::optional<Game> &game) {
+  std::string_view line;
+  while (next_line(line)) {
+    if (trim(line).empty()) {
+      continue;
+    }
+    Parser parser(line);
+    game.emplace(parser);
+    return true;
+  }
+  return false;
+}
+
+// The strain of a contract or bid, in which notrump may be given as "N".
+static Suit parse_strain(Parser &parser) {
+  if (parser.try_parse("NT") || parser.try_parse('N')) {
+    return NO_TRUMP;
+  }
+  return parse_suit(parser);
+}
+
+// ---
+// PBN
+// ---
+
+// A board's tags, which refer to the file's text.
+struct PbnBoard {
+  std::string_view deal;
+  std::string_view contract;
+  std::string_view declarer;
+};
+
+// Parses `[Name "Value"]`, returning false for a malformed tag.
+static bool parse_pbn_tag(
+    std::string_view line, std::string_view &name, std::string_view &value
+) {
+  if (!line.starts_with('[') || !line.ends_with(']')) {
+    return false;
+  }
+  line = line.substr(1, line.size() - 2);
+  std::size_t space = line.find(' ');
+  std::size_t open  = line.find('"');
+  if (space == std::string_view::npos || open == std::string_view::npos ||
+      !line.ends_with('"') || open + 1 >= line.size()) {
+    return false;
+  }
+  name  = line.substr(0, space);
+  value = line.substr(open + 1, line.size() - open - 2);
+  return true;
+}
+
+// Parses `<SEAT>:<HAND> <HAND> <HAND> <HAND>`, where the hands are given
+// clockwise from the first seat.
+static Hands parse_pbn_deal(std::string_view deal) {
+  Parser parser(deal);
+  Seat   seat = parse_seat(parser);
+  if (!parser.try_parse(':')) {
+    throw parser.error("expected ':'");
+  }
+  std::array<Cards, 4> hands;
+  for (int i = 0; i < 4; i++) {
+    parser.skip_whitespace();
+    hands[right_seat(seat, i)] = Cards(parser);
+  }
+  return Hands(hands[WEST], hands[NORTH], hands[EAST], hands[SOUTH]);
+}
+
+// Makes the game played at a board, if the board was played in a contract.
+static bool make_pbn_game(const PbnBoard &board, std::optional<Game> &game) {
+  if (board.deal.empty() || board.contract.empty() ||
+      board.declarer.empty() || board.contract == "Pass") {
+    return false;
+  }
+  Parser contract(board.contract);
+  if (contract.finished() || !std::isdigit(contract.peek())) {
+    throw contract.error("expected contract level");
+  }
+  contract.try_parse(contract.peek());
+  Suit strain   = parse_strain(contract);
+  Seat declarer = parse_seat(board.declarer);
+  game.emplace(strain, right_seat(declarer), parse_pbn_deal(board.deal));
+  return true;
+}
+
+bool DealReader::next_pbn(std::optional<Game> &game) {
+  PbnBoard         board;
+  bool             in_comment = false;
+  std::string_view line;
+  while (next_line(line)) {
+    line = trim(line);
+
+    // Comments may span several lines.
+    if (in_comment || line.starts_with('{')) {
+      in_comment = line.find('}') == std::string_view::npos;
+      continue;
+    }
+
+    // Boards are separated by empty lines. Lines which are not tags (e.g.,
+    // the auction and play) and escaped lines are skipped.
+    std::string_view name, value;
+    if (line.empty()) {
+      if (make_pbn_game(board, game)) {
+        return true;
+      }
+      board = {};
+    } else if (parse_pbn_tag(line, name, value)) {
+      if (name == "Deal") {
+        board.deal = value;
+      } else if (name == "Contract") {
+        board.contract = value;
+      } else if (name == "Declarer") {
+        board.declarer = value;
+      }
+    }
+  }
+  return make_pbn_game(board, game);
+}
+
+// ---
+// LIN
+// ---
+
+// Parses a hand such as `SAKQHJT9D876C5432`.
+static Cards parse_lin_hand(Parser &parser) {
+  Cards cards;
+  Suit  suit = NO_TRUMP;
+  while (!parser.finished() && parser.peek() != ',') {
+    char c = parser.peek();
+    if (c == 'S' || c == 'H' || c == 'D' || c == 'C') {
+      suit = parse_suit(parser);
+    } else if (suit == NO_TRUMP) {
+      throw parser.error("expected suit");
+    } else {
+      cards.add(Card(parse_rank(parser), suit));
+    }
+  }
+  return cards;
+}
+
+// Parses `<DEALER><HAND>,<HAND>,<HAND>,[<HAND>]`, where the dealer is given
+// as 1 to 4 for South, West, North and East, and the hands are given
+// clockwise from South. The last hand of a full deal may be omitted, in which
+// case it holds the remaining cards.
+static Hands parse_lin_deal(std::string_view deal, Seat &dealer) {
+  Parser parser(deal);
+  if (parser.finished() || parser.peek() < '1' || parser.peek() > '4') {
+    throw parser.error("expected dealer");
+  }
+  dealer = right_seat(SOUTH, parser.peek() - '1');
+  parser.try_parse(parser.peek());
+
+  std::array<Cards, 4> hands;
+  Cards                dealt;
+  for (int i = 0; i < 4; i++) {
+    if (i > 0 && !parser.try_parse(',')) {
+      if (i < 3) {
+        throw parser.error("expected ','");
+      }
+      break;
+    }
+    hands[right_seat(SOUTH, i)] = parse_lin_hand(parser);
+    dealt.add_all(hands[right_seat(SOUTH, i)]);
+  }
+  if (hands[EAST].empty()) {
+    hands[EAST] = dealt.complement();
+  }
+  return Hands(hands[WEST], hands[NORTH], hands[EAST], hands[SOUTH]);
+}
+
+// Follows an auction, tracking the final contract and its declarer.
+class LinAuction {
+public:
+  LinAuction(Seat dealer) : next_seat_(dealer), level_(0) {
+    for (auto &first : first_bidder_) {
+      first.fill(NO_SEAT);
+    }
+  }
+
+  void bid(std::string_view call) {
+    // Calls are case insensitive, and may be followed by an alert ('!').
+    char buf[4] = {};
+    for (std::size_t i = 0; i < call.size() && i < 3 && call[i] != '!'; i++) {
+      buf[i] = (char)std::toupper((unsigned char)call[i]);
+    }
+    Parser parser(buf);
+    if (!parser.finished() && std::isdigit(parser.peek())) {
+      level_ = parser.peek() - '0';
+      parser.try_parse(parser.peek());
+      strain_     = parse_strain(parser);
+      Seat &first = first_bidder_[next_seat_ % 2][strain_];
+      if (first == NO_SEAT) {
+        first = next_seat_;
+      }
+      declarer_ = first;
+    }
+    next_seat_ = right_seat(next_seat_);
+  }
+
+  // Whether a contract was reached, i.e., the auction was not passed out.
+  bool has_contract() const { return level_ > 0; }
+  Suit strain() const { return strain_; }
+  Seat declarer() const { return declarer_; }
+
+private:
+  Seat                               next_seat_;
+  int                                level_;
+  Suit                               strain_;
+  Seat                               declarer_;
+  std::array<std::array<Seat, 5>, 2> first_bidder_;
+};
+
+bool DealReader::next_lin(std::optional<Game> &game) {
+  std::optional<Hands>      hands;
+  std::optional<LinAuction> auction;
+  auto                      make_game = [&]() {
+    if (!hands || !auction || !auction->has_contract()) {
+      return false;
+    }
+    Seat leader = right_seat(auction->declarer());
+    game.emplace(auction->strain(), leader, *hands);
+    return true;
+  };
+
+  // Reads `<KEY>|<VALUE>|` pairs, where a new board starts at each `md` key.
+  while (true) {
+    std::string_view pair_start = remaining_;
+    std::size_t      key_end    = remaining_.find('|');
+    if (key_end == std::string_view::npos) {
+      remaining_ = {};
+      return make_game();
+    }
+    std::string_view key       = trim(remaining_.substr(0, key_end));
+    std::size_t      value_end = remaining_.find('|', key_end + 1);
+    if (value_end == std::string_view::npos) {
+      value_end = remaining_.size();
+    }
+    std::string_view value =
+        remaining_.substr(key_end + 1, value_end - key_end - 1);
+    remaining_.remove_prefix(std::min(value_end + 1, remaining_.size()));
+
+    if (key == "md") {
+      if (make_game()) {
+        // Leaves the new board for the next read.
+        remaining_ = pair_start;
+        return true;
+      }
+      Seat dealer;
+      hands = parse_lin_deal(trim(value), dealer);
+      auction.emplace(dealer);
+    } else if (key == "mb" && auction) {
+      auction->bid(trim(value));
+    }
+  }
+}
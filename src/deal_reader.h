@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "game_model.h"
+
+enum DealFormat {
+  // One game per line: `<SUIT> <SEAT> <HANDS>`, optionally followed by the
+  // cards already played to the current trick.
+  FORMAT_TEXT,
+  // Portable Bridge Notation, with a game for each board's `Deal`, `Contract`
+  // and `Declarer` tags.
+  FORMAT_PBN,
+  // BBO hand records, with a game for each board's `md` deal and the contract
+  // reached by its `mb` auction.
+  FORMAT_LIN,
+};
+
+DealFormat parse_deal_format(std::string_view str);
+
+// Reads games from deal files, parsing them in place (e.g., from a mapped
+// file) without copying. In the PBN and LIN formats, each board is solved for
+// its contract, with declarer's left-hand opponent on lead. Boards which were
+// passed out, or whose contract is unknown, are skipped.
+class DealReader {
+public:
+  DealReader(std::string_view text, DealFormat format);
+
+  // Reads the next game, returning false at the end of input.
+  bool next(std::optional<Game> &game);
+
+private:
+  bool next_line(std::string_view &line);
+  bool next_text(std::optional<Game> &game);
+  bool next_pbn(std::optional<Game> &game);
+  bool next_lin(std::optional<Game> &game);
+
+  std::string_view remaining_;
+  DealFormat       format_;
+};
@@ -0,0 +1,251 @@
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <vector>
+
+#include "dumdum.h"
+#include "solver.h"
+#include "table_solver.h"
+#include "thread_pool.h"
+
+static_assert(DUMDUM_CLUBS == CLUBS && DUMDUM_NO_TRUMP == NO_TRUMP);
+static_assert(DUMDUM_WEST == WEST && DUMDUM_SOUTH == SOUTH);
+
+struct dumdum_pool {
+  dumdum_pool(int num_threads, int64_t tpn_memory_budget)
+      : threads(num_threads - 1),
+        solvers(num_threads),
+        tpn_memory_budget(tpn_memory_budget) {}
+
+  // Each task of a batch runs on one thread, using the solver with the same
+  // index as the task, so there is one more solver than there are worker
+  // threads for the task run by the thread submitting the batch.
+  ThreadPool                         threads;
+  std::vector<std::optional<Solver>> solvers;
+  int64_t                            tpn_memory_budget;
+  std::mutex                         batch_mutex;
+};
+
+// Returns the status for the exception being handled.
+static int exception_status() {
+  try {
+    throw;
+  } catch (const std::bad_alloc &) {
+    return DUMDUM_ERROR_OUT_OF_MEMORY;
+  } catch (...) {
+    return DUMDUM_ERROR_INTERNAL;
+  }
+}
+
+static bool make_hands(const uint64_t hands[4], Hands &h) {
+  constexpr uint64_t ALL_CARDS = (1ull << 52) - 1;
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    if (hands[seat] & ~ALL_CARDS) {
+      return false;
+    }
+  }
+  h = Hands(
+      Cards(hands[WEST]),
+      Cards(hands[NORTH]),
+      Cards(hands[EAST]),
+      Cards(hands[SOUTH])
+  );
+  return h.all_same_size() && h.all_disjoint();
+}
+
+static bool make_game(const dumdum_game &g, std::optional<Game> &game) {
+  Hands hands;
+  if (g.strain < CLUBS || g.strain > NO_TRUMP || g.leader < FIRST_SEAT ||
+      g.leader > LAST_SEAT || !make_hands(g.hands, hands)) {
+    return false;
+  }
+  game.emplace((Suit)g.strain, (Seat)g.leader, hands);
+  return true;
+}
+
+// Returns a solver for the game, reusing one solver per calling thread.
+static Solver &thread_solver(const Game &game) {
+  static thread_local std::optional<Solver> solver;
+  if (solver) {
+    solver->reset(game);
+  } else {
+    solver.emplace(game);
+  }
+  return *solver;
+}
+
+static dumdum_result to_result(const Solver::Result &r, const Solver &s) {
+  return {
+      .tricks_ns      = r.tricks_taken_by_ns,
+      .tricks_ew      = r.tricks_taken_by_ew,
+      .nodes_explored = s.stats().nodes_explored,
+  };
+}
+
+int dumdum_abi_version(void) { return DUMDUM_ABI_VERSION; }
+
+const char *dumdum_status_message(int status) {
+  switch (status) {
+  case DUMDUM_OK:
+    return "ok";
+  case DUMDUM_ERROR_INVALID_ARGUMENT:
+    return "invalid argument";
+  case DUMDUM_ERROR_INVALID_GAME:
+    return "invalid game";
+  case DUMDUM_ERROR_OUT_OF_MEMORY:
+    return "out of memory";
+  case DUMDUM_ERROR_INTERNAL:
+    return "internal error";
+  default:
+    return "unknown status";
+  }
+}
+
+int dumdum_solve(const dumdum_game *game, dumdum_result *result) {
+  if (!game || !result) {
+    return DUMDUM_ERROR_INVALID_ARGUMENT;
+  }
+  try {
+    std::optional<Game> g;
+    if (!make_game(*game, g)) {
+      return DUMDUM_ERROR_INVALID_GAME;
+    }
+    Solver &s = thread_solver(*g);
+    *result   = to_result(s.solve(), s);
+    return DUMDUM_OK;
+  } catch (...) {
+    return exception_status();
+  }
+}
+
+int dumdum_solve_all_plays(
+    const dumdum_game *game,
+    dumdum_result     *result,
+    dumdum_play       *plays,
+    int               *num_plays
+) {
+  if (!game || !result || !plays || !num_plays) {
+    return DUMDUM_ERROR_INVALID_ARGUMENT;
+  }
+  try {
+    static thread_local std::vector<Solver::PlayResult> play_results;
+    std::optional<Game>                                 g;
+    if (!make_game(*game, g)) {
+      return DUMDUM_ERROR_INVALID_GAME;
+    }
+    Solver &s = thread_solver(*g);
+    *result   = to_result(s.solve_all_plays(play_results), s);
+    *num_plays = (int)play_results.size();
+    for (int i = 0; i < *num_plays; i++) {
+      plays[i] = {
+          .card      = Cards().with(play_results[i].card).bits(),
+          .tricks_ns = play_results[i].tricks_taken_by_ns,
+          .tricks_ew = play_results[i].tricks_taken_by_ew,
+      };
+    }
+    return DUMDUM_OK;
+  } catch (...) {
+    return exception_status();
+  }
+}
+
+int dumdum_solve_table(const uint64_t hands[4], dumdum_table *table) {
+  if (!hands || !table) {
+    return DUMDUM_ERROR_INVALID_ARGUMENT;
+  }
+  try {
+    Hands h;
+    if (!make_hands(hands, h)) {
+      return DUMDUM_ERROR_INVALID_GAME;
+    }
+    TableSolver::Result r = TableSolver(h).solve();
+    for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+      for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+        table->tricks[strain][seat] = (int8_t)r.tricks(strain, seat);
+      }
+    }
+    return DUMDUM_OK;
+  } catch (...) {
+    return exception_status();
+  }
+}
+
+dumdum_pool *dumdum_pool_create(int num_threads, int64_t tpn_memory_budget) {
+  try {
+    return new dumdum_pool(std::max(1, num_threads), tpn_memory_budget);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void dumdum_pool_destroy(dumdum_pool *pool) { delete pool; }
+
+namespace {
+
+struct Batch {
+  dumdum_pool        *pool;
+  const dumdum_game  *games;
+  size_t              num_games;
+  dumdum_result      *results;
+  std::atomic<size_t> next_game = 0;
+  std::atomic<bool>   invalid   = false;
+  std::atomic<int>    error     = DUMDUM_OK;
+
+  // Solves games until none are left, using the given solver.
+  void run(std::optional<Solver> &solver) {
+    std::optional<Game> game;
+    size_t              i;
+    while ((i = next_game++) < num_games) {
+      results[i] = {.tricks_ns = -1, .tricks_ew = -1, .nodes_explored = 0};
+      try {
+        if (!make_game(games[i], game)) {
+          invalid = true;
+          continue;
+        }
+        if (solver) {
+          solver->reset(*game);
+        } else {
+          solver.emplace(*game);
+          solver->tpn_table().enable_memory_budget(pool->tpn_memory_budget);
+        }
+        results[i] = to_result(solver->solve(), *solver);
+      } catch (...) {
+        error = exception_status();
+      }
+    }
+  }
+};
+
+} // namespace
+
+int dumdum_solve_batch(
+    dumdum_pool       *pool,
+    const dumdum_game *games,
+    size_t             num_games,
+    dumdum_result     *results
+) {
+  if (!pool || (num_games > 0 && (!games || !results))) {
+    return DUMDUM_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::lock_guard<std::mutex> lock(pool->batch_mutex);
+
+  Batch batch = {
+      .pool      = pool,
+      .games     = games,
+      .num_games = num_games,
+      .results   = results,
+  };
+  ThreadPool::TaskGroup group;
+  for (std::size_t i = 0; i < pool->solvers.size(); i++) {
+    auto &solver = pool->solvers[i];
+    pool->threads.run(group, [&batch, &solver]() { batch.run(solver); });
+  }
+  pool->threads.wait(group);
+
+  if (batch.error != DUMDUM_OK) {
+    return batch.error;
+  }
+  return batch.invalid ? DUMDUM_ERROR_INVALID_GAME : DUMDUM_OK;
+}
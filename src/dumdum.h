@@ -0,0 +1,136 @@
+#ifndef DUMDUM_H
+#define DUMDUM_H
+
+/*
+ * C interface to the dumdum double dummy solver, for embedding the solver in
+ * other programs. All functions are thread safe, and report errors by
+ * returning a nonzero status.
+ *
+ * Cards are represented as 64-bit masks, with the card of rank r (0 for a two,
+ * up to 12 for an ace) in suit s at bit 4 * r + s.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(DUMDUM_BUILD_SHARED)
+#define DUMDUM_API __declspec(dllexport)
+#elif defined(DUMDUM_SHARED)
+#define DUMDUM_API __declspec(dllimport)
+#else
+#define DUMDUM_API
+#endif
+#elif defined(__GNUC__)
+#define DUMDUM_API __attribute__((visibility("default")))
+#else
+#define DUMDUM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremented on any incompatible change to this interface. */
+#define DUMDUM_ABI_VERSION 1
+
+/* Strains, which also index the suits of a card. */
+#define DUMDUM_CLUBS    0
+#define DUMDUM_DIAMONDS 1
+#define DUMDUM_HEARTS   2
+#define DUMDUM_SPADES   3
+#define DUMDUM_NO_TRUMP 4
+
+/* Seats, which index the hands of a deal. */
+#define DUMDUM_WEST  0
+#define DUMDUM_NORTH 1
+#define DUMDUM_EAST  2
+#define DUMDUM_SOUTH 3
+
+/* The mask bit of a card, e.g. DUMDUM_CARD(12, DUMDUM_SPADES) for the ace of
+ * spades. */
+#define DUMDUM_CARD(rank, suit) (1ull << (4 * (rank) + (suit)))
+
+/* Statuses returned by each function. */
+#define DUMDUM_OK                    0
+#define DUMDUM_ERROR_INVALID_ARGUMENT 1
+#define DUMDUM_ERROR_INVALID_GAME    2
+#define DUMDUM_ERROR_OUT_OF_MEMORY   3
+#define DUMDUM_ERROR_INTERNAL        4
+
+/* A game at the start of play. All hands must have the same number of cards
+ * (at most 13), and no card may be held by more than one hand. */
+typedef struct dumdum_game {
+  uint64_t hands[4]; /* indexed by seat */
+  int      strain;
+  int      leader;
+} dumdum_game;
+
+typedef struct dumdum_result {
+  int     tricks_ns;
+  int     tricks_ew;
+  int64_t nodes_explored;
+} dumdum_result;
+
+/* The result of one of the leader's plays. */
+typedef struct dumdum_play {
+  uint64_t card; /* a mask with a single bit set */
+  int      tricks_ns;
+  int      tricks_ew;
+} dumdum_play;
+
+/* The number of tricks taken by each declarer in each strain. */
+typedef struct dumdum_table {
+  int8_t tricks[5][4]; /* indexed by strain, then declarer */
+} dumdum_table;
+
+/* A pool of threads, each keeping a solver from one game to the next. */
+typedef struct dumdum_pool dumdum_pool;
+
+DUMDUM_API int dumdum_abi_version(void);
+
+/* Returns a short description of a status. */
+DUMDUM_API const char *dumdum_status_message(int status);
+
+DUMDUM_API int dumdum_solve(const dumdum_game *game, dumdum_result *result);
+
+/* Solves the game, and also the result of each of the leader's valid plays.
+ * The plays array must have room for 13 plays, and the number of plays
+ * written is stored in num_plays. */
+DUMDUM_API int dumdum_solve_all_plays(
+    const dumdum_game *game,
+    dumdum_result     *result,
+    dumdum_play       *plays,
+    int               *num_plays
+);
+
+DUMDUM_API int
+dumdum_solve_table(const uint64_t hands[4], dumdum_table *table);
+
+/* Creates a pool with the given number of threads, including the thread
+ * calling dumdum_solve_batch. A nonzero memory budget bounds the memory used
+ * by each thread's transposition table. Returns NULL on failure. */
+DUMDUM_API dumdum_pool *
+dumdum_pool_create(int num_threads, int64_t tpn_memory_budget);
+
+DUMDUM_API void dumdum_pool_destroy(dumdum_pool *pool);
+
+/* Solves each of num_games games into the result at the same index, using
+ * the pool's threads. Each thread's solver keeps its memory from one game to
+ * the next, so once it has grown to fit the largest game the thread has
+ * solved, solving a batch allocates no memory. Every valid game is solved
+ * even when others are not, in which case their results are set to -1 and
+ * DUMDUM_ERROR_INVALID_GAME is returned. Batches submitted concurrently to
+ * the same pool are solved one at a time. */
+DUMDUM_API int dumdum_solve_batch(
+    dumdum_pool       *pool,
+    const dumdum_game *games,
+    size_t             num_games,
+    dumdum_result     *results
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DUMDUM_H */
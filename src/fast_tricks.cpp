@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "fast_tricks.h"
 
 class FastTricksAnalyzer {
@@ -333,3 +335,136 @@ void estimate_fast_tricks(
   FastTricksAnalyzer solver(hands, my_seat, trump_suit);
   solver.solve(fast_tricks, winners_by_rank);
 }
+
+// The tricks won by the top trumps of the side not on lead. Each top trump in
+// a hand wins a separate trick, but may fall with a top trump of partner, so
+// only the top trumps of one hand are counted.
+static void top_trump_tricks(
+    const Hands &hands,
+    Seat         lead_seat,
+    Suit         trump_suit,
+    int         &tricks,
+    Cards       &winners_by_rank
+) {
+  Seat lho = right_seat(lead_seat, 1);
+  Seat rho = right_seat(lead_seat, 3);
+
+  // Counted separately for each hand, LHO first.
+  int  count[2] = {0, 0};
+  Card lowest[2];
+  for (Card c : hands.all_cards().intersect(trump_suit).high_to_low()) {
+    int i;
+    if (hands.hand(lho).contains(c)) {
+      i = 0;
+    } else if (hands.hand(rho).contains(c)) {
+      i = 1;
+    } else {
+      break;
+    }
+    count[i]++;
+    lowest[i] = c;
+  }
+  // Of hands with as many top trumps, the one whose lowest top trump is
+  // highest needs the fewest winners by rank.
+  bool higher = lowest[1].rank() > lowest[0].rank();
+  int  best   = count[1] > count[0] || (count[1] == count[0] && higher) ? 1 : 0;
+  tricks      = count[best];
+  if (tricks > 0) {
+    winners_by_rank = Cards::higher_ranking_or_eq(lowest[best]);
+  }
+}
+
+// Whether the side not on lead wins the current trick, as the leader holds no
+// suit which is headed by the leader's side, or which partner may ruff.
+static bool wins_current_trick(
+    const Hands &hands,
+    Seat         lead_seat,
+    Suit         trump_suit,
+    Cards       &winners_by_rank
+) {
+  Cards leader  = hands.hand(lead_seat);
+  Cards partner = hands.hand(right_seat(lead_seat, 2));
+  if (leader.empty()) {
+    return false;
+  }
+  bool partner_has_trumps =
+      trump_suit != NO_TRUMP && !partner.intersect(trump_suit).empty();
+  for (Suit suit = FIRST_SUIT; suit <= LAST_SUIT; suit++) {
+    if (leader.intersect(suit).empty()) {
+      continue;
+    }
+    Card top = hands.all_cards().intersect(suit).highest();
+    if (leader.contains(top) || partner.contains(top)) {
+      return false;
+    }
+    if (suit != trump_suit && partner_has_trumps &&
+        partner.intersect(suit).empty()) {
+      return false;
+    }
+    winners_by_rank.add_all(Cards::higher_ranking_or_eq(top));
+  }
+  return true;
+}
+
+// Whether the side not on lead wins a later trick, as the side on lead cannot
+// take all the remaining tricks in the suits it heads ("later tricks"). Without
+// trumps, the side on lead takes no more tricks in a suit than the length of
+// its longer hand in the suit, and to take a trick in a suit headed by the
+// other side, must first force them to discard the top card.
+static bool wins_later_trick(
+    const Hands &hands,
+    Seat         lead_seat,
+    Suit         trump_suit,
+    Cards       &winners_by_rank
+) {
+  Cards all_cards = hands.all_cards();
+  if (trump_suit != NO_TRUMP && !all_cards.intersect(trump_suit).empty()) {
+    return false;
+  }
+  Cards leader     = hands.hand(lead_seat);
+  Cards partner    = hands.hand(right_seat(lead_seat, 2));
+  int   max_tricks = 0;
+  for (Suit suit = FIRST_SUIT; suit <= LAST_SUIT; suit++) {
+    Cards cards = all_cards.intersect(suit);
+    if (cards.empty()) {
+      continue;
+    }
+    Card top = cards.highest();
+    if (leader.contains(top) || partner.contains(top)) {
+      max_tricks += std::max(
+          leader.intersect(suit).count(), partner.intersect(suit).count()
+      );
+    }
+    winners_by_rank.add_all(Cards::higher_ranking_or_eq(top));
+  }
+  return max_tricks < leader.count();
+}
+
+void estimate_sure_tricks(
+    const Hands &hands,
+    Seat         lead_seat,
+    Suit         trump_suit,
+    int         &sure_tricks,
+    Cards       &winners_by_rank
+) {
+  sure_tricks     = 0;
+  winners_by_rank = Cards();
+  if (trump_suit != NO_TRUMP) {
+    top_trump_tricks(
+        hands, lead_seat, trump_suit, sure_tricks, winners_by_rank
+    );
+  }
+
+  if (sure_tricks > 0) {
+    return;
+  }
+  Cards current_trick_wbr;
+  Cards later_trick_wbr;
+  if (wins_current_trick(hands, lead_seat, trump_suit, current_trick_wbr)) {
+    sure_tricks     = 1;
+    winners_by_rank = current_trick_wbr;
+  } else if (wins_later_trick(hands, lead_seat, trump_suit, later_trick_wbr)) {
+    sure_tricks     = 1;
+    winners_by_rank = later_trick_wbr;
+  }
+}
@@ -9,3 +9,16 @@ void estimate_fast_tricks(
     int         &fast_tricks,
     Cards       &winners_by_rank
 );
+
+// Estimates the tricks which the side not on lead is sure to take, however the
+// side on lead plays: the tricks won by their top trumps, or else one trick,
+// if they hold the top card in each suit the leader may lead, or if (without
+// trumps) the side on lead heads too few suits to take every trick. This is an
+// upper bound for the side on lead, where their fast tricks are a lower bound.
+void estimate_sure_tricks(
+    const Hands &hands,
+    Seat         lead_seat,
+    Suit         trump_suit,
+    int         &sure_tricks,
+    Cards       &winners_by_rank
+);
@@ -284,6 +284,12 @@ int Trick::card_value(Card c) const {
   }
 }
 
+// The unit of a suit's length within a shape, where the first seat's last suit
+// takes the lowest bits.
+static uint64_t suit_length_unit(Seat seat, Suit suit) {
+  return (uint64_t)1 << 3 * (seat * 4 + LAST_SUIT - suit);
+}
+
 Game::Game(Suit trump_suit, Seat lead_seat, const Hands &hands)
     : hands_(hands),
       trump_suit_(trump_suit),
@@ -291,7 +297,8 @@ Game::Game(Suit trump_suit, Seat lead_seat, const Hands &hands)
       next_seat_(lead_seat),
       tricks_taken_(0),
       tricks_max_(hands.hand(FIRST_SEAT).count()),
-      tricks_taken_by_ns_(0) {
+      tricks_taken_by_ns_(0),
+      suit_lengths_(0) {
   if (!hands.all_same_size()) {
     throw std::runtime_error("hands must be same size");
   }
@@ -300,8 +307,60 @@ Game::Game(Suit trump_suit, Seat lead_seat, const Hands &hands)
   }
 
   card_normalizer_.remove_all(hands.all_cards().complement());
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    for (Suit suit = FIRST_SUIT; suit <= LAST_SUIT; suit++) {
+      suit_lengths_ += hands.hand(seat).intersect(suit).count() *
+                       suit_length_unit(seat, suit);
+    }
+  }
 }
 
+static Hands
+add_trick_cards(Hands hands, Seat lead_seat, const std::vector<Card> &trick) {
+  if (trick.size() >= 4) {
+    throw std::runtime_error("trick must have at most 3 cards");
+  }
+  for (int i = 0; i < (int)trick.size(); i++) {
+    if (hands.all_cards().contains(trick[i])) {
+      throw std::runtime_error("hands must be disjoint");
+    }
+    hands.add_card(right_seat(lead_seat, i), trick[i]);
+  }
+  return hands;
+}
+
+Game::Game(
+    Suit                     trump_suit,
+    Seat                     lead_seat,
+    const Hands             &hands,
+    const std::vector<Card> &trick
+)
+    : Game(trump_suit, lead_seat, add_trick_cards(hands, lead_seat, trick)) {
+  for (Card c : trick) {
+    if (!valid_play(c)) {
+      throw std::runtime_error(std::format("invalid play: {}", c));
+    }
+    play(c);
+  }
+}
+
+static Game parse_game(Parser &parser) {
+  Suit trump_suit = parse_suit(parser);
+  parser.skip_whitespace();
+  Seat lead_seat = parse_seat(parser);
+  parser.skip_whitespace();
+  Hands hands(parser);
+  parser.skip_whitespace();
+  std::vector<Card> trick;
+  while (!parser.finished()) {
+    trick.emplace_back(parser);
+    parser.skip_whitespace();
+  }
+  return Game(trump_suit, lead_seat, hands, trick);
+}
+
+Game::Game(Parser &parser) : Game(parse_game(parser)) {}
+
 Suit         Game::trump_suit() const { return trump_suit_; }
 Seat         Game::lead_seat() const { return lead_seat_; }
 Cards        Game::hand(Seat seat) const { return hands_.hand(seat); }
@@ -333,6 +392,9 @@ int Game::tricks_taken_by_ns() const { return tricks_taken_by_ns_; }
 int Game::tricks_taken_by_ew() const {
   return tricks_taken_ - tricks_taken_by_ns_;
 }
+uint64_t Game::shape() const {
+  return suit_lengths_ + ((uint64_t)next_seat_ << 48);
+}
 bool Game::finished() const { return tricks_taken_ == tricks_max_; }
 bool Game::start_of_trick() const { return !current_trick().started(); }
 
@@ -376,6 +438,7 @@ void Game::play(Card c) {
     t.play_start(trump_suit_, next_seat_, c);
   }
   hands_.remove_card(next_seat_, c);
+  suit_lengths_ -= suit_length_unit(next_seat_, c.suit());
 
   if (t.finished()) {
     next_seat_ = t.winning_seat();
@@ -407,6 +470,7 @@ void Game::unplay() {
     }
     if (c.has_value()) {
       hands_.add_card(next_seat_, *c);
+      suit_lengths_ += suit_length_unit(next_seat_, c->suit());
     }
   } else {
     if (tricks_taken_ > 0) {
@@ -420,6 +484,7 @@ void Game::unplay() {
       next_seat_                 = t.next_seat();
       if (card.has_value()) {
         hands_.add_card(next_seat_, *card);
+        suit_lengths_ += suit_length_unit(next_seat_, card->suit());
       }
       if (winner == NORTH || winner == SOUTH) {
         tricks_taken_by_ns_--;
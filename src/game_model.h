@@ -4,6 +4,7 @@
 #include <format>
 #include <iostream>
 #include <optional>
+#include <vector>
 
 #include "card_model.h"
 #include "parser.h"
@@ -103,6 +104,17 @@ private:
 class Game {
 public:
   Game(Suit trump_suit, Seat first_lead_seat, const Hands &hands);
+  // Creates a game starting in the middle of a trick, given the cards not yet
+  // played and the cards already played to the trick, starting with the lead.
+  Game(
+      Suit                     trump_suit,
+      Seat                     first_lead_seat,
+      const Hands             &hands,
+      const std::vector<Card> &trick
+  );
+  // Parses a game from `<SUIT> <SEAT> <HANDS>`, optionally followed by the
+  // cards already played to the current trick.
+  Game(Parser &parser);
 
   Suit         trump_suit() const;
   Seat         lead_seat() const;
@@ -124,6 +136,10 @@ public:
   int  tricks_max() const;
   int  tricks_taken_by_ns() const;
   int  tricks_taken_by_ew() const;
+  // The length of each suit in each hand, 3 bits each, followed by the next
+  // seat. Positions with the same shape share a transposition table bucket.
+  // Kept up to date as cards are played and unplayed.
+  uint64_t shape() const;
 
   void play(Card card);
   void unplay();
@@ -149,6 +165,7 @@ private:
   int                tricks_taken_;
   int                tricks_max_;
   int                tricks_taken_by_ns_;
+  uint64_t           suit_lengths_;
   CardNormalizer     card_normalizer_;
   mutable HandsStack norm_hands_stack_;
 };
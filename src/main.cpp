@@ -1,30 +1,199 @@
 #include <argparse/argparse.hpp>
+#include <atomic>
 #include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <variant>
+#include <vector>
 
+#include "deal_corpus.h"
+#include "deal_reader.h"
 #include "game_model.h"
+#include "mtdf.h"
+#include "par_solver.h"
+#include "parallel_solver.h"
 #include "random.h"
+#include "search_bench.h"
+#include "server.h"
+#include "smp_solver.h"
 #include "solver.h"
+#include "table_solver.h"
+
+struct BatchOpts {
+  int         num_threads;
+  int         search_threads;
+  std::string search_mode;
+  bool        mtdf;
+  bool        all_plays;
+  int64_t     tpn_memory_budget = 0;
+  bool        compact_output;
+  bool        unordered_output;
+};
 
 struct FileOpts {
   std::string path;
-  bool        compact_output;
+  std::string format;
+  bool        binary;
+  BatchOpts   batch;
 };
 
 struct RandomOpts {
-  int  initial_seed;
-  int  num_hands;
-  int  deal_size;
-  bool compact_output;
+  int       initial_seed;
+  int       num_hands;
+  int       deal_size;
+  BatchOpts batch;
 };
 
-using Options = std::variant<FileOpts, RandomOpts>;
+struct TableOpts {
+  std::string path;
+  int         num_threads;
+  int64_t     tpn_memory_budget = 0;
+  bool        compact_output;
+};
+
+struct ParOpts {
+  std::string path;
+  std::string dealer;
+  int64_t     tpn_memory_budget = 0;
+  bool        compact_output;
+};
+
+struct ReplayOpts {
+  std::string path;
+  int64_t     tpn_memory_budget = 0;
+};
+
+struct ConvertOpts {
+  std::string input_path;
+  std::string output_path;
+  std::string format;
+  bool        to_text;
+};
+
+struct ServeOpts {
+  std::string socket_path;
+  int         num_threads;
+  int64_t     tpn_memory_budget = 0;
+};
+
+struct SearchBenchOpts {
+  std::string path;
+  std::string baseline_path;
+  double      threshold;
+  int64_t     tpn_memory_budget = 0;
+};
+
+using Options = std::variant<
+    FileOpts,
+    RandomOpts,
+    TableOpts,
+    ParOpts,
+    ReplayOpts,
+    ConvertOpts,
+    ServeOpts,
+    SearchBenchOpts>;
+
+// Parses a byte count with an optional K, M or G suffix, e.g. "256M".
+static int64_t parse_bytes(const std::string &s) {
+  std::size_t pos;
+  int64_t     bytes = std::stoll(s, &pos);
+  int         shift = 0;
+  if (pos < s.size()) {
+    switch (std::toupper(s[pos++])) {
+    case 'K': shift = 10; break;
+    case 'M': shift = 20; break;
+    case 'G': shift = 30; break;
+    default: pos = 0; break;
+    }
+  }
+  if (pos != s.size() || bytes < 0 ||
+      bytes > (std::numeric_limits<int64_t>::max() >> shift)) {
+    throw std::invalid_argument("invalid memory size: " + s);
+  }
+  return bytes << shift;
+}
+
+static void add_tpn_memory_argument(
+    argparse::ArgumentParser &parser, int64_t &tpn_memory_budget
+) {
+  parser.add_argument("--tpn-mem")
+      .action([&](const std::string &s) {
+        tpn_memory_budget = parse_bytes(s);
+      })
+      .nargs(1)
+      .metavar("BYTES")
+      .help("transposition table memory budget, e.g. 256M");
+}
+
+static void
+add_batch_arguments(argparse::ArgumentParser &parser, BatchOpts &opts) {
+  parser.add_argument("-t", "--threads")
+      .default_value(1)
+      .store_into(opts.num_threads)
+      .nargs(1)
+      .metavar("N")
+      .help("number of worker threads (0 for one per core)");
+  parser.add_argument("-p", "--search-threads")
+      .default_value(1)
+      .store_into(opts.search_threads)
+      .nargs(1)
+      .metavar("N")
+      .help("number of threads searching each hand");
+  parser.add_argument("--search-mode")
+      .default_value(std::string("smp"))
+      .choices("smp", "ybwc")
+      .store_into(opts.search_mode)
+      .nargs(1)
+      .metavar("MODE")
+      .help("parallel search mode (lazy SMP or young brothers wait)");
+  parser.add_argument("-m", "--mtdf")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(opts.mtdf)
+      .help("solve using a sequence of zero-window searches (MTD(f))");
+  parser.add_argument("-a", "--all-plays")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(opts.all_plays)
+      .help("also solve every valid play for the next seat (with one search "
+            "thread)");
+  add_tpn_memory_argument(parser, opts.tpn_memory_budget);
+  parser.add_argument("-u", "--unordered")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(opts.unordered_output)
+      .help("print results as they complete, tagged by sequence number");
+  parser.add_argument("-c", "--compact")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(opts.compact_output)
+      .help("compact output");
+}
+
+// All plays are solved with one search thread, sharing one table.
+static void check_batch_arguments(const BatchOpts &opts) {
+  if (opts.all_plays && (opts.search_threads > 1 || opts.mtdf)) {
+    throw std::invalid_argument(
+        "--all-plays cannot be combined with --search-threads or --mtdf"
+    );
+  }
+}
 
 static Options parse_arguments(int argc, char **argv) {
-  FileOpts   solve_opts;
-  RandomOpts random_opts;
+  FileOpts        solve_opts;
+  RandomOpts      random_opts;
+  TableOpts       table_opts;
+  ParOpts         par_opts;
+  ReplayOpts      replay_opts;
+  ConvertOpts     convert_opts;
+  ServeOpts       serve_opts;
+  SearchBenchOpts bench_opts;
 
   argparse::ArgumentParser program("dumdum");
 
@@ -34,11 +203,19 @@ static Options parse_arguments(int argc, char **argv) {
       .help("file containing hands to solve")
       .store_into(solve_opts.path)
       .required();
-  file.add_argument("-c", "--compact")
+  file.add_argument("-f", "--format")
+      .default_value(std::string("text"))
+      .choices("text", "pbn", "lin")
+      .store_into(solve_opts.format)
+      .nargs(1)
+      .metavar("FORMAT")
+      .help("format of the file (text, pbn or lin)");
+  file.add_argument("--binary")
       .default_value(false)
       .implicit_value(true)
-      .store_into(solve_opts.compact_output)
-      .help("compact output");
+      .store_into(solve_opts.binary)
+      .help("read a binary deal corpus (see the convert command)");
+  add_batch_arguments(file, solve_opts.batch);
 
   argparse::ArgumentParser random("random");
   random.add_description("Solve randomly generated hands.");
@@ -60,17 +237,140 @@ static Options parse_arguments(int argc, char **argv) {
       .nargs(1)
       .metavar("N")
       .help("number of cards per hand in each deal");
-  random.add_argument("-c", "--compact")
+  add_batch_arguments(random, random_opts.batch);
+
+  argparse::ArgumentParser table("table");
+  table.add_description(
+      "Solve the double dummy table (all strains and declarers) for hands "
+      "read from a file."
+  );
+  table.add_argument("file")
+      .help("file containing hands to solve, one deal per line")
+      .store_into(table_opts.path)
+      .required();
+  table.add_argument("-t", "--threads")
+      .default_value(1)
+      .store_into(table_opts.num_threads)
+      .nargs(1)
+      .metavar("N")
+      .help("number of threads used to solve strains in parallel");
+  add_tpn_memory_argument(table, table_opts.tpn_memory_budget);
+  table.add_argument("-c", "--compact")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(table_opts.compact_output)
+      .help("compact output");
+
+  argparse::ArgumentParser par("par");
+  par.add_description(
+      "Compute the par result for each vulnerability for hands read from a "
+      "file."
+  );
+  par.add_argument("file")
+      .help("file containing hands to solve, one deal per line")
+      .store_into(par_opts.path)
+      .required();
+  par.add_argument("-d", "--dealer")
+      .default_value(std::string("N"))
+      .store_into(par_opts.dealer)
+      .nargs(1)
+      .metavar("SEAT")
+      .help("dealer, whose side bids first");
+  add_tpn_memory_argument(par, par_opts.tpn_memory_budget);
+  par.add_argument("-c", "--compact")
       .default_value(false)
       .implicit_value(true)
-      .store_into(random_opts.compact_output)
+      .store_into(par_opts.compact_output)
       .help("compact output");
 
+  argparse::ArgumentParser replay("replay");
+  replay.add_description(
+      "Solve the position after every card played in games read from a file."
+  );
+  replay.add_argument("file")
+      .help("file containing hands and the cards played, one game per line")
+      .store_into(replay_opts.path)
+      .required();
+  add_tpn_memory_argument(replay, replay_opts.tpn_memory_budget);
+
+  argparse::ArgumentParser convert("convert");
+  convert.add_description(
+      "Convert hands between the text format and a binary deal corpus."
+  );
+  convert.add_argument("input")
+      .help("file to convert")
+      .store_into(convert_opts.input_path)
+      .required();
+  convert.add_argument("output")
+      .help("file to write")
+      .store_into(convert_opts.output_path)
+      .required();
+  convert.add_argument("-f", "--format")
+      .default_value(std::string("text"))
+      .choices("text", "pbn", "lin")
+      .store_into(convert_opts.format)
+      .nargs(1)
+      .metavar("FORMAT")
+      .help("format of the input file (text, pbn or lin)");
+  convert.add_argument("--to-text")
+      .default_value(false)
+      .implicit_value(true)
+      .store_into(convert_opts.to_text)
+      .help("convert a binary corpus to text, rather than text to binary");
+
+  argparse::ArgumentParser serve("serve");
+  serve.add_description(
+      "Answer requests, one per line, from stdin or a Unix domain socket."
+  );
+  serve.add_argument("-s", "--socket")
+      .store_into(serve_opts.socket_path)
+      .nargs(1)
+      .metavar("PATH")
+      .help("listen on a Unix domain socket instead of stdin");
+  serve.add_argument("-t", "--threads")
+      .default_value(1)
+      .store_into(serve_opts.num_threads)
+      .nargs(1)
+      .metavar("N")
+      .help("number of threads answering requests in parallel");
+  add_tpn_memory_argument(serve, serve_opts.tpn_memory_budget);
+
+  argparse::ArgumentParser bench("bench");
+  bench.add_description(
+      "Measure search efficiency on a corpus of deals (e.g., "
+      "bench/search_corpus.txt), printing a line of JSON for each deal, each "
+      "group of deals of the same size and strain, and in total."
+  );
+  bench.add_argument("file")
+      .help("file containing hands to solve, one game per line")
+      .store_into(bench_opts.path)
+      .required();
+  bench.add_argument("-b", "--baseline")
+      .store_into(bench_opts.baseline_path)
+      .nargs(1)
+      .metavar("FILE")
+      .help("output of a previous run to compare against");
+  bench.add_argument("--threshold")
+      .default_value(5.0)
+      .store_into(bench_opts.threshold)
+      .nargs(1)
+      .metavar("PCT")
+      .help("percentage growth over the baseline reported as a regression");
+  add_tpn_memory_argument(bench, bench_opts.tpn_memory_budget);
+
   program.add_subparser(file);
   program.add_subparser(random);
+  program.add_subparser(table);
+  program.add_subparser(par);
+  program.add_subparser(replay);
+  program.add_subparser(convert);
+  program.add_subparser(serve);
+  program.add_subparser(bench);
 
   try {
     program.parse_args(argc, argv);
+    check_batch_arguments(solve_opts.batch);
+    check_batch_arguments(random_opts.batch);
   } catch (const std::exception &err) {
     std::cerr << err.what() << std::endl;
     std::cerr << program;
@@ -81,65 +381,221 @@ static Options parse_arguments(int argc, char **argv) {
     return solve_opts;
   } else if (program.is_subcommand_used(random)) {
     return random_opts;
+  } else if (program.is_subcommand_used(table)) {
+    return table_opts;
+  } else if (program.is_subcommand_used(par)) {
+    return par_opts;
+  } else if (program.is_subcommand_used(replay)) {
+    return replay_opts;
+  } else if (program.is_subcommand_used(convert)) {
+    return convert_opts;
+  } else if (program.is_subcommand_used(serve)) {
+    return serve_opts;
+  } else if (program.is_subcommand_used(bench)) {
+    return bench_opts;
   } else {
     std::cerr << program;
     std::exit(1);
   }
 }
 
-static void print_compact_output_headers() {
+static void print_compact_output_headers(const BatchOpts &opts) {
   std::ostream_iterator<char> out(std::cout);
+  if (opts.unordered_output) {
+    std::format_to(out, "{:10}", "seq");
+  }
   std::format_to(
-      out,
-      "{:10}{:10}{:10}{:10}{:10}\n",
-      "trumps",
-      "seat",
-      "tricks",
-      "elapsed",
-      "hands"
+      out, "{:10}{:10}{:10}{:10}", "trumps", "seat", "tricks", "elapsed"
   );
+  if (opts.all_plays) {
+    std::format_to(out, "{:40}", "plays");
+  }
+  std::format_to(out, "{:10}\n", "hands");
 }
 
-static int64_t solve_game(Game &g, bool compact_output) {
-  Solver s(g);
+template <class S>
+static Solver::Result
+solve_timed(S &s, const Game &g, bool mtdf, int64_t &elapsed_ms) {
+  auto begin = std::chrono::steady_clock::now();
+  auto r     = mtdf ? solve_mtdf(s, g, estimate_tricks(g)) : s.solve();
+  auto end   = std::chrono::steady_clock::now();
+  elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+  return r;
+}
 
+static Solver::Result solve_all_plays_timed(
+    Solver &s, std::vector<Solver::PlayResult> &plays, int64_t &elapsed_ms
+) {
   auto begin = std::chrono::steady_clock::now();
-  auto r     = s.solve();
+  auto r     = s.solve_all_plays(plays);
   auto end   = std::chrono::steady_clock::now();
-  auto elapsed_ms =
+  elapsed_ms =
       std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
           .count();
+  return r;
+}
+
+static std::string
+format_plays(const std::vector<Solver::PlayResult> &plays) {
+  std::string s;
+  for (const auto &p : plays) {
+    if (!s.empty()) {
+      s += ' ';
+    }
+    std::format_to(
+        std::back_inserter(s), "{}:{}", p.card, p.tricks_taken_by_ns
+    );
+  }
+  return s;
+}
+
+// Solvers reused by a batch worker from one hand to the next, so that their
+// memory (and threads) remain allocated.
+struct WorkerSolvers {
+  std::optional<Solver>         solver;
+  std::optional<SmpSolver>      smp_solver;
+  std::optional<ParallelSolver> parallel_solver;
+};
+
+template <class S, class... Args>
+static S &reuse_solver(std::optional<S> &s, const Game &g, Args... args) {
+  if (s) {
+    s->reset(g);
+  } else {
+    s.emplace(g, args...);
+  }
+  return *s;
+}
+
+// Prints a row of search counters for each depth searched, from the first
+// trick to the last, where `pos` is the position of the next play in the
+// trick.
+static void
+format_search_counters(std::string &output, const SearchCounters &counters) {
+  auto out = std::back_inserter(output);
+  std::format_to(
+      out,
+      "search_counters    {:>6}{:>4}{:>12}{:>12}{:>12}{:>12}{:>11}{:>11}{:>10}"
+      "{:>11}\n",
+      "tricks",
+      "pos",
+      "nodes",
+      "tpn_lookups",
+      "tpn_hits",
+      "tpn_inserts",
+      "ft_cutoffs",
+      "ct_cutoffs",
+      "branching",
+      "terminals"
+  );
+  for (int tricks = 13; tricks >= 0; tricks--) {
+    for (int pos = 0; pos < 4; pos++) {
+      const SearchCounters::Depth &d = counters.depths[tricks][pos];
+      if (d.empty()) {
+        continue;
+      }
+      std::format_to(
+          out,
+          "                   {:>6}{:>4}{:>12}{:>12}{:>12}{:>12}{:>11}{:>11}"
+          "{:>10.2f}{:>11}\n",
+          tricks,
+          pos + 1,
+          d.nodes,
+          d.tpn_lookups,
+          d.tpn_hits,
+          d.tpn_inserts,
+          d.ft_cutoffs,
+          d.ct_cutoffs,
+          d.branching_factor(),
+          d.terminals
+      );
+    }
+  }
+}
+
+static int64_t solve_game(
+    int64_t          seq,
+    Game            &g,
+    const BatchOpts &opts,
+    WorkerSolvers   &solvers,
+    std::string     &output
+) {
+  Solver::Result                  r;
+  Solver::Stats                   stats;
+  int64_t                         elapsed_ms;
+  std::vector<Solver::PlayResult> plays;
+
+  if (opts.all_plays) {
+    // Plays are solved one after another, sharing one transposition table.
+    auto &s = reuse_solver(solvers.solver, g);
+    s.tpn_table().enable_memory_budget(opts.tpn_memory_budget);
+    r     = solve_all_plays_timed(s, plays, elapsed_ms);
+    stats = s.stats();
+  } else if (opts.search_threads > 1 && opts.search_mode == "ybwc") {
+    auto &s = reuse_solver(solvers.parallel_solver, g, opts.search_threads);
+    s.tpn_table().enable_memory_budget(opts.tpn_memory_budget);
+    r     = solve_timed(s, g, opts.mtdf, elapsed_ms);
+    stats = s.stats();
+  } else if (opts.search_threads > 1) {
+    auto &s = reuse_solver(solvers.smp_solver, g, opts.search_threads);
+    s.tpn_table().enable_memory_budget(opts.tpn_memory_budget);
+    r     = solve_timed(s, g, opts.mtdf, elapsed_ms);
+    stats = s.stats();
+  } else {
+    auto &s = reuse_solver(solvers.solver, g);
+    s.tpn_table().enable_memory_budget(opts.tpn_memory_budget);
+    r     = solve_timed(s, g, opts.mtdf, elapsed_ms);
+    stats = s.stats();
+  }
 
-  auto  stats     = s.stats();
   auto &tpn_stats = stats.tpn_table_stats;
 
-  std::ostream_iterator<char> out(std::cout);
+  auto out = std::back_inserter(output);
 
-  if (compact_output) {
+  if (opts.compact_output) {
+    if (opts.unordered_output) {
+      std::format_to(out, "{:<10}", seq);
+    }
     std::format_to(
         out,
-        "{:<10}{:<10}{:<10}{:<10}{}\n",
+        "{:<10}{:<10}{:<10}{:<10}",
         suit_to_ascii(g.trump_suit()),
         g.next_seat(),
         r.tricks_taken_by_ns,
-        elapsed_ms,
-        g.hands()
+        elapsed_ms
     );
+    if (opts.all_plays) {
+      std::format_to(out, "{:<40}", format_plays(plays));
+    }
+    std::format_to(out, "{}\n", g.hands());
   } else {
     std::string_view trumps = suit_to_ascii(g.trump_suit());
+    if (opts.unordered_output) {
+      std::format_to(out, "seq                {}\n", seq);
+    }
     std::format_to(out, "hands              {}\n", g.hands());
     std::format_to(out, "trump_suit         {}\n", trumps);
     std::format_to(out, "next_seat          {}\n", g.next_seat());
     std::format_to(out, "best_tricks_by_ns  {}\n", r.tricks_taken_by_ns);
     std::format_to(out, "best_tricks_by_ew  {}\n", r.tricks_taken_by_ew);
+    if (opts.all_plays) {
+      std::format_to(out, "play_tricks_by_ns  {}\n", format_plays(plays));
+    }
     std::format_to(out, "nodes_explored     {}\n", stats.nodes_explored);
     std::format_to(out, "tpn_buckets        {}\n", tpn_stats.buckets);
     std::format_to(out, "tpn_entries        {}\n", tpn_stats.entries);
+    std::format_to(out, "tpn_bytes          {}\n", tpn_stats.bytes);
+    std::format_to(out, "tpn_evicted        {}\n", tpn_stats.evicted_buckets);
     std::format_to(out, "tpn_lookup_hits    {}\n", tpn_stats.lookup_hits);
     std::format_to(out, "tpn_lookup_misses  {}\n", tpn_stats.lookup_misses);
     std::format_to(out, "tpn_insert_hits    {}\n", tpn_stats.insert_hits);
     std::format_to(out, "tpn_insert_misses  {}\n", tpn_stats.insert_misses);
     std::format_to(out, "tpn_insert_reads   {}\n", tpn_stats.insert_reads);
+    if constexpr (SearchCounters::ENABLED) {
+      format_search_counters(output, stats.search_counters);
+    }
     std::format_to(out, "elapsed_ms         {}\n", elapsed_ms);
     std::format_to(out, "\n");
   }
@@ -147,25 +603,144 @@ static int64_t solve_game(Game &g, bool compact_output) {
   return elapsed_ms;
 }
 
-template <class Generator>
-static void solve_games(Generator &game_generator, bool compact_output) {
-  if (compact_output) {
-    print_compact_output_headers();
+// Hands out games from a generator to worker threads, tagging each game with
+// its sequence number in the input.
+template <class Generator> class GameQueue {
+public:
+  GameQueue(Generator &generator) : generator_(generator), next_seq_(0) {}
+
+  bool next(int64_t &seq, std::optional<Game> &game) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!generator_.has_next()) {
+      return false;
+    }
+    seq = next_seq_++;
+    game.emplace(generator_.next());
+    return true;
   }
 
-  int64_t total_ms  = 0;
-  int     num_hands = 0;
-  while (game_generator.has_next()) {
-    Game game = game_generator.next();
-    total_ms += solve_game(game, compact_output);
-    num_hands++;
+private:
+  Generator &generator_;
+  int64_t    next_seq_;
+  std::mutex mutex_;
+};
+
+// Hands out games from a binary corpus to worker threads. Each thread claims
+// the index of its next game without locking, and decodes the game directly
+// from the mapped file.
+class CorpusQueue {
+public:
+  CorpusQueue(const DealCorpus &corpus) : corpus_(corpus), next_seq_(0) {}
+
+  bool next(int64_t &seq, std::optional<Game> &game) {
+    seq = next_seq_++;
+    if (seq >= (int64_t)corpus_.size()) {
+      return false;
+    }
+    game.emplace(corpus_.game(seq));
+    return true;
   }
-  int64_t avg_ms = total_ms / num_hands;
+
+private:
+  const DealCorpus    &corpus_;
+  std::atomic<int64_t> next_seq_;
+};
+
+// Writes solver output to stdout, either in input order (buffering results
+// which complete early) or in order of completion.
+class OutputWriter {
+public:
+  OutputWriter(bool ordered) : ordered_(ordered), next_seq_(0) {}
+
+  void write(int64_t seq, std::string output) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ordered_) {
+      std::cout << output;
+      return;
+    }
+    pending_.emplace(seq, std::move(output));
+    while (!pending_.empty() && pending_.begin()->first == next_seq_) {
+      std::cout << pending_.begin()->second;
+      pending_.erase(pending_.begin());
+      next_seq_++;
+    }
+  }
+
+private:
+  bool                           ordered_;
+  int64_t                        next_seq_;
+  std::map<int64_t, std::string> pending_;
+  std::mutex                     mutex_;
+};
+
+template <class Queue>
+static void solve_games(Queue &queue, const BatchOpts &opts) {
+  if (opts.compact_output) {
+    print_compact_output_headers(opts);
+  }
+
+  int num_threads = opts.num_threads;
+  if (num_threads <= 0) {
+    num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  OutputWriter         writer(!opts.unordered_output);
+  std::atomic<int64_t> solve_ms  = 0;
+  std::atomic<int64_t> num_hands = 0;
+  std::exception_ptr   error;
+  std::mutex           error_mutex;
+  // Set once a worker fails. The failed game's output is never written, so
+  // ordered output can go no further, and the other workers stop taking
+  // games rather than buffering their results until the rethrow.
+  std::atomic<bool> stopped = false;
+
+  auto worker = [&]() {
+    try {
+      int64_t             seq;
+      std::optional<Game> game;
+      WorkerSolvers       solvers;
+      while (!stopped && queue.next(seq, game)) {
+        std::string output;
+        solve_ms += solve_game(seq, *game, opts, solvers, output);
+        num_hands++;
+        writer.write(seq, std::move(output));
+      }
+    } catch (...) {
+      stopped = true;
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  auto begin = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  auto total_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+  int64_t avg_ms        = num_hands > 0 ? solve_ms / num_hands : 0;
+  double  hands_per_sec = num_hands * 1000.0 / std::max(total_ms, (int64_t)1);
 
   std::ostream_iterator<char> out(std::cout);
   std::format_to(out, "\n");
   std::format_to(out, "total_elapsed_ms   {}\n", total_ms);
   std::format_to(out, "avg_elapsed_ms     {}\n", avg_ms);
+  std::format_to(out, "hands_per_sec      {:.1f}\n", hands_per_sec);
 }
 
 class RandomGenerator {
@@ -185,43 +760,372 @@ private:
   int               index_ = 0;
 };
 
+// Reads games from a mapped file, in any of the formats read by DealReader.
 class FileGenerator {
 public:
-  FileGenerator(const std::string &path) : ifs_(path) {
-    if (!ifs_) {
-      throw std::runtime_error(std::format("failed to open file: {}", path));
-    }
-    std::getline(ifs_, next_);
+  FileGenerator(const std::string &path, DealFormat format)
+      : file_(path),
+        reader_(
+            std::string_view((const char *)file_.data(), file_.size()), format
+        ) {
+    read_next();
   }
 
-  bool has_next() const { return (bool)ifs_; }
+  bool has_next() const { return next_.has_value() || error_; }
 
   Game next() {
     assert(has_next());
-    Parser parser(next_);
-    Suit   trumps = parse_suit(parser);
-    parser.skip_whitespace();
-    Seat seat = parse_seat(parser);
-    parser.skip_whitespace();
-    Hands hands(parser);
-    std::getline(ifs_, next_);
-    return Game(trumps, seat, hands);
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    Game game = *next_;
+    next_.reset();
+    read_next();
+    return game;
   }
 
 private:
-  std::ifstream ifs_;
-  std::string   next_;
+  // Games are read one ahead. An error reading a game is held until the
+  // games before it have been taken, then thrown in place of the game.
+  void read_next() {
+    try {
+      reader_.next(next_);
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+  }
+
+  MappedFile          file_;
+  DealReader          reader_;
+  std::optional<Game> next_;
+  std::exception_ptr  error_;
+};
+
+static void solve_table(const Hands &hands, const TableOpts &opts) {
+  TableSolver s(hands);
+  s.enable_threads(opts.num_threads);
+  s.enable_tpn_memory_budget(opts.tpn_memory_budget);
+
+  auto begin = std::chrono::steady_clock::now();
+  auto r     = s.solve();
+  auto end   = std::chrono::steady_clock::now();
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+
+  std::ostream_iterator<char> out(std::cout);
+
+  if (opts.compact_output) {
+    std::string table = std::format("{}", r);
+    std::format_to(out, "{:<10}{:<26}{}\n", elapsed_ms, table, hands);
+  } else {
+    std::format_to(out, "hands              {}\n", hands);
+    std::format_to(out, "strain             W  N  E  S\n");
+    for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+      std::format_to(
+          out,
+          "{:<19}{:<3}{:<3}{:<3}{}\n",
+          suit_to_ascii(strain),
+          r.tricks(strain, WEST),
+          r.tricks(strain, NORTH),
+          r.tricks(strain, EAST),
+          r.tricks(strain, SOUTH)
+      );
+    }
+    std::format_to(out, "nodes_explored     {}\n", s.stats().nodes_explored);
+    std::format_to(out, "elapsed_ms         {}\n", elapsed_ms);
+    std::format_to(out, "\n");
+  }
+}
+
+static void solve_tables(const TableOpts &opts) {
+  std::ifstream ifs(opts.path);
+  if (!ifs) {
+    throw std::runtime_error(std::format("failed to open file: {}", opts.path)
+    );
+  }
+
+  if (opts.compact_output) {
+    std::ostream_iterator<char> out(std::cout);
+    std::format_to(out, "{:10}{:26}{:10}\n", "elapsed", "table", "hands");
+  }
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    solve_table(Hands(line), opts);
+  }
+}
+
+static void solve_par(const Hands &hands, const ParOpts &opts) {
+  ParSolver s(hands, parse_seat(opts.dealer));
+  s.enable_tpn_memory_budget(opts.tpn_memory_budget);
+
+  auto begin = std::chrono::steady_clock::now();
+  auto r     = s.solve();
+  auto end   = std::chrono::steady_clock::now();
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+
+  std::ostream_iterator<char> out(std::cout);
+
+  if (opts.compact_output) {
+    std::format_to(out, "{:<10}", elapsed_ms);
+    for (const auto &result : r) {
+      std::string par = std::format("{}", result);
+      std::format_to(out, "{:<16}", par);
+    }
+    std::format_to(out, "{}\n", hands);
+  } else {
+    std::format_to(out, "hands              {}\n", hands);
+    std::format_to(out, "par_none           {}\n", r[VUL_NONE]);
+    std::format_to(out, "par_ns             {}\n", r[VUL_NS]);
+    std::format_to(out, "par_ew             {}\n", r[VUL_EW]);
+    std::format_to(out, "par_both           {}\n", r[VUL_BOTH]);
+    std::format_to(out, "nodes_explored     {}\n", s.stats().nodes_explored);
+    std::format_to(out, "elapsed_ms         {}\n", elapsed_ms);
+    std::format_to(out, "\n");
+  }
+}
+
+static void solve_pars(const ParOpts &opts) {
+  std::ifstream ifs(opts.path);
+  if (!ifs) {
+    throw std::runtime_error(std::format("failed to open file: {}", opts.path)
+    );
+  }
+
+  if (opts.compact_output) {
+    std::ostream_iterator<char> out(std::cout);
+    std::format_to(
+        out,
+        "{:10}{:16}{:16}{:16}{:16}{:10}\n",
+        "elapsed",
+        "none",
+        "ns",
+        "ew",
+        "both",
+        "hands"
+    );
+  }
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    solve_par(Hands(line), opts);
+  }
+}
+
+// A replay line: `<SUIT> <SEAT> <HANDS>`, followed by the cards played.
+struct GameLine {
+  Suit              trumps;
+  Seat              seat;
+  Hands             hands;
+  std::vector<Card> cards;
 };
 
+static GameLine parse_game_line(std::string_view line) {
+  Parser   parser(line);
+  GameLine g;
+  g.trumps = parse_suit(parser);
+  parser.skip_whitespace();
+  g.seat = parse_seat(parser);
+  parser.skip_whitespace();
+  g.hands = Hands(parser);
+  parser.skip_whitespace();
+  while (!parser.finished()) {
+    g.cards.emplace_back(parser);
+    parser.skip_whitespace();
+  }
+  return g;
+}
+
+static void solve_replay(
+    const GameLine &line, std::optional<Solver> &solver, const ReplayOpts &opts
+) {
+  auto &s = reuse_solver(solver, Game(line.trumps, line.seat, line.hands));
+  s.tpn_table().enable_memory_budget(opts.tpn_memory_budget);
+
+  auto begin   = std::chrono::steady_clock::now();
+  auto results = s.solve_replay(line.cards);
+  auto end     = std::chrono::steady_clock::now();
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+
+  // Each result is printed below the play which reached its position.
+  std::string plays = "   ";
+  std::string tricks;
+  for (Card c : line.cards) {
+    std::string card = std::format("{}", c);
+    std::format_to(std::back_inserter(plays), "{:<3}", card);
+  }
+  for (const auto &r : results) {
+    std::format_to(std::back_inserter(tricks), "{:<3}", r.tricks_taken_by_ns);
+  }
+
+  std::ostream_iterator<char> out(std::cout);
+  std::format_to(out, "hands              {}\n", line.hands);
+  std::format_to(out, "trump_suit         {}\n", suit_to_ascii(line.trumps));
+  std::format_to(out, "lead_seat          {}\n", line.seat);
+  std::format_to(out, "plays              {}\n", plays);
+  std::format_to(out, "tricks_by_ns       {}\n", tricks);
+  std::format_to(out, "nodes_explored     {}\n", s.stats().nodes_explored);
+  std::format_to(out, "elapsed_ms         {}\n", elapsed_ms);
+  std::format_to(out, "\n");
+}
+
+static void solve_replays(const ReplayOpts &opts) {
+  std::ifstream ifs(opts.path);
+  if (!ifs) {
+    throw std::runtime_error(std::format("failed to open file: {}", opts.path)
+    );
+  }
+
+  std::optional<Solver> solver;
+  std::string           line;
+  while (std::getline(ifs, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    solve_replay(parse_game_line(line), solver, opts);
+  }
+}
+
+static void convert(const ConvertOpts &opts) {
+  std::ofstream ofs(opts.output_path, std::ios::binary);
+  if (!ofs) {
+    throw std::runtime_error(
+        std::format("failed to open file: {}", opts.output_path)
+    );
+  }
+
+  if (opts.to_text) {
+    DealCorpus                  corpus(opts.input_path);
+    std::ostream_iterator<char> out(ofs);
+    for (std::size_t i = 0; i < corpus.size(); i++) {
+      Game g = corpus.game(i);
+      std::format_to(
+          out,
+          "{} {} {}\n",
+          suit_to_ascii(g.trump_suit()),
+          g.lead_seat(),
+          g.hands()
+      );
+    }
+  } else {
+    FileGenerator generator(opts.input_path, parse_deal_format(opts.format));
+    DealCorpus::write_header(ofs);
+    while (generator.has_next()) {
+      DealCorpus::write_game(ofs, generator.next());
+    }
+  }
+
+  if (!ofs.flush()) {
+    throw std::runtime_error(
+        std::format("failed to write file: {}", opts.output_path)
+    );
+  }
+}
+
+static void serve(const ServeOpts &opts) {
+  Server server;
+  server.enable_threads(opts.num_threads);
+  server.enable_tpn_memory_budget(opts.tpn_memory_budget);
+  if (opts.socket_path.empty()) {
+    server.serve(std::cin, std::cout);
+  } else {
+    server.serve_unix_socket(opts.socket_path);
+  }
+}
+
+// Returns false if any regressions from the baseline were found.
+static bool search_bench(const SearchBenchOpts &opts) {
+  std::vector<Game> games;
+  FileGenerator     generator(opts.path, FORMAT_TEXT);
+  while (generator.has_next()) {
+    games.push_back(generator.next());
+  }
+
+  auto records = run_search_bench(games, opts.tpn_memory_budget);
+  for (const BenchRecord &record : records) {
+    std::cout << record.to_json() << '\n';
+  }
+  std::cout << std::flush;
+
+  if (opts.baseline_path.empty()) {
+    return true;
+  }
+  std::ifstream ifs(opts.baseline_path);
+  if (!ifs) {
+    throw std::runtime_error(
+        std::format("failed to open file: {}", opts.baseline_path)
+    );
+  }
+  std::vector<BenchRecord> baseline;
+  std::string              line;
+  while (std::getline(ifs, line)) {
+    if (!line.empty()) {
+      baseline.push_back(BenchRecord::from_json(line));
+    }
+  }
+
+  // Regressions are reported on stderr, so that the output may be saved as
+  // the next baseline.
+  auto regressions =
+      compare_search_bench(baseline, records, opts.threshold / 100);
+  std::ostream_iterator<char> err(std::cerr);
+  for (const BenchRegression &r : regressions) {
+    std::format_to(
+        err,
+        "regression: {} {} {} -> {}\n",
+        r.name,
+        r.metric,
+        r.baseline,
+        r.current
+    );
+  }
+  std::format_to(err, "regressions: {}\n", regressions.size());
+  return regressions.empty();
+}
+
 int main(int argc, char **argv) {
   Options options = parse_arguments(argc, argv);
 
   if (auto opts = std::get_if<FileOpts>(&options)) {
-    FileGenerator generator(opts->path);
-    solve_games(generator, opts->compact_output);
+    if (opts->binary) {
+      DealCorpus  corpus(opts->path);
+      CorpusQueue queue(corpus);
+      solve_games(queue, opts->batch);
+    } else {
+      DealFormat               format = parse_deal_format(opts->format);
+      FileGenerator            generator(opts->path, format);
+      GameQueue<FileGenerator> queue(generator);
+      solve_games(queue, opts->batch);
+    }
   } else if (auto opts = std::get_if<RandomOpts>(&options)) {
-    RandomGenerator generator(*opts);
-    solve_games(generator, opts->compact_output);
+    RandomGenerator            generator(*opts);
+    GameQueue<RandomGenerator> queue(generator);
+    solve_games(queue, opts->batch);
+  } else if (auto opts = std::get_if<TableOpts>(&options)) {
+    solve_tables(*opts);
+  } else if (auto opts = std::get_if<ParOpts>(&options)) {
+    solve_pars(*opts);
+  } else if (auto opts = std::get_if<ReplayOpts>(&options)) {
+    solve_replays(*opts);
+  } else if (auto opts = std::get_if<ConvertOpts>(&options)) {
+    convert(*opts);
+  } else if (auto opts = std::get_if<ServeOpts>(&options)) {
+    serve(*opts);
+  } else if (auto opts = std::get_if<SearchBenchOpts>(&options)) {
+    if (!search_bench(*opts)) {
+      return 1;
+    }
   } else {
     throw std::runtime_error("unrecognized opts"); // unreachable
   }
@@ -0,0 +1,82 @@
+#include <cerrno>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+MappedFile::MappedFile(const std::string &path)
+    : data_(nullptr),
+      size_(0),
+      mapping_(nullptr) {
+#ifdef _WIN32
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error(std::format("failed to open file: {}", path));
+  }
+  contents_.assign(
+      std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()
+  );
+  data_ = contents_.data();
+  size_ = contents_.size();
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(std::format("failed to open file: {}", path));
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    throw std::runtime_error(std::format("failed to stat file: {}", path));
+  }
+  // Only regular files have a size, and may be mapped.
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      // Records are typically read once each, in order.
+      madvise(p, st.st_size, MADV_SEQUENTIAL);
+      mapping_ = p;
+      data_    = (const uint8_t *)p;
+      size_    = (std::size_t)st.st_size;
+    }
+  }
+  if (!mapping_) {
+    // Pipes and the like, and files which fail to map, are read instead.
+    uint8_t buffer[1 << 16];
+    while (true) {
+      ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0) {
+        close(fd);
+        throw std::runtime_error(std::format("failed to read file: {}", path)
+        );
+      }
+      if (n == 0) {
+        break;
+      }
+      contents_.insert(contents_.end(), buffer, buffer + n);
+    }
+    data_ = contents_.data();
+    size_ = contents_.size();
+  }
+  // The mapping remains valid once the file is closed.
+  close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (mapping_) {
+    munmap(mapping_, size_);
+  }
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A read-only view of a file's contents. The file is mapped into memory
+// where possible, so that it may be read concurrently by several threads
+// without copying. Files which cannot be mapped (on Windows, or pipes and
+// other special files) are read into memory instead.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &)            = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const uint8_t *data() const { return data_; }
+  std::size_t    size() const { return size_; }
+
+private:
+  const uint8_t       *data_;
+  std::size_t          size_;
+  void                *mapping_;
+  std::vector<uint8_t> contents_;
+};
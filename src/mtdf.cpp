@@ -0,0 +1,24 @@
+#include "mtdf.h"
+#include "fast_tricks.h"
+
+int estimate_tricks(const Game &game) {
+  if (!game.start_of_trick()) {
+    return game.tricks_taken_by_ns() + game.tricks_left() / 2;
+  }
+
+  int   fast_tricks;
+  Cards winners_by_rank;
+  estimate_fast_tricks(
+      game.hands(),
+      game.next_seat(),
+      game.trump_suit(),
+      fast_tricks,
+      winners_by_rank
+  );
+
+  if (game.next_seat() == NORTH || game.next_seat() == SOUTH) {
+    return game.tricks_taken_by_ns() + fast_tricks;
+  } else {
+    return game.tricks_taken_by_ns() + game.tricks_left() - fast_tricks;
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+
+#include "game_model.h"
+#include "solver.h"
+
+// Estimates the number of tricks taken by NS, for use as the first guess of
+// an MTD(f) search. At the start of a trick, the estimate is the bound given by
+// the fast tricks of the side on lead.
+int estimate_tricks(const Game &game);
+
+// Solves a game using a sequence of zero-window searches ("MTD(f)"), starting
+// from the given guess of the number of tricks taken by NS. Each search either
+// raises the lower bound or lowers the upper bound on the result, until the
+// bounds meet. The solver should use a transposition table, which preserves
+// the bounds proven by each search for the next. Works with any solver type
+// providing `solve(alpha, beta)`.
+template <typename S>
+Solver::Result solve_mtdf(S &solver, const Game &game, int guess);
+// As above, given known bounds on the number of tricks taken by NS.
+template <typename S>
+Solver::Result solve_mtdf(
+    S &solver, const Game &game, int guess, int lower_bound, int upper_bound
+);
+
+// ----------------------
+// Implementation Details
+// ----------------------
+
+template <typename S>
+Solver::Result solve_mtdf(S &solver, const Game &game, int guess) {
+  return solve_mtdf(
+      solver,
+      game,
+      guess,
+      game.tricks_taken_by_ns(),
+      game.tricks_taken_by_ns() + game.tricks_left()
+  );
+}
+
+template <typename S>
+Solver::Result solve_mtdf(
+    S &solver, const Game &game, int guess, int lower_bound, int upper_bound
+) {
+  Cards winners_by_rank;
+
+  guess = std::clamp(guess, lower_bound, upper_bound);
+  while (lower_bound < upper_bound) {
+    int  beta = guess == lower_bound ? guess + 1 : guess;
+    auto r    = solver.solve(beta - 1, beta);
+    // The result depends on the winners by rank of every search which proved
+    // one of the bounds.
+    winners_by_rank.add_all(r.winners_by_rank);
+    guess = r.tricks_taken_by_ns;
+    if (guess < beta) {
+      upper_bound = guess;
+    } else {
+      lower_bound = guess;
+    }
+  }
+
+  return {
+      .tricks_taken_by_ns = lower_bound,
+      .tricks_taken_by_ew = game.tricks_max() - lower_bound,
+      .winners_by_rank    = winners_by_rank,
+  };
+}
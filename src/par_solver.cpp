@@ -0,0 +1,276 @@
+#include <cassert>
+#include <climits>
+#include <tuple>
+
+#include "par_solver.h"
+
+// Contracts are ranked from 1♣ (0) to 7NT (34).
+constexpr int NUM_CONTRACTS = 35;
+
+static bool is_ns(Seat seat) { return seat == NORTH || seat == SOUTH; }
+
+int contract_score(int level, Suit strain, int tricks, bool vulnerable) {
+  int needed = level + 6;
+  if (tricks < needed) {
+    // Doubled undertricks score 100, 200, 200, then 300 each when not
+    // vulnerable, or 200, then 300 each when vulnerable.
+    int down = needed - tricks;
+    if (vulnerable) {
+      return -(300 * down - 100);
+    }
+    return -(down <= 3 ? 200 * down - 100 : 300 * down - 400);
+  }
+
+  int trick_value     = strain == CLUBS || strain == DIAMONDS ? 20 : 30;
+  int contract_points = level * trick_value + (strain == NO_TRUMP ? 10 : 0);
+  int score           = contract_points + (tricks - needed) * trick_value;
+  if (contract_points >= 100) {
+    score += vulnerable ? 500 : 300;
+  } else {
+    score += 50;
+  }
+  if (level == 6) {
+    score += vulnerable ? 750 : 500;
+  } else if (level == 7) {
+    score += vulnerable ? 1500 : 1000;
+  }
+  return score;
+}
+
+ParSolver::ParSolver(const Hands &hands, Seat dealer)
+    : hands_(hands),
+      dealer_(dealer),
+      tpn_memory_budget_(0) {}
+
+Solver::Stats ParSolver::stats() const {
+  Solver::Stats stats = {};
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      if (solvers_[strain][seat]) {
+        auto solver_stats = solvers_[strain][seat]->stats();
+        stats.nodes_explored += solver_stats.nodes_explored;
+        stats.tpn_table_stats.add_counters(solver_stats.tpn_table_stats);
+        stats.search_counters.add(solver_stats.search_counters);
+      }
+    }
+    if (tpn_tables_[strain]) {
+      auto tpn_table_stats = tpn_tables_[strain]->stats();
+      stats.tpn_table_stats.buckets += tpn_table_stats.buckets;
+      stats.tpn_table_stats.entries += tpn_table_stats.entries;
+      stats.tpn_table_stats.bytes += tpn_table_stats.bytes;
+      stats.tpn_table_stats.evicted_buckets += tpn_table_stats.evicted_buckets;
+    }
+  }
+  return stats;
+}
+
+void ParSolver::enable_tpn_memory_budget(int64_t max_bytes) {
+  tpn_memory_budget_ = max_bytes;
+}
+
+// Returns a table with the NS cells of one table and the EW cells of another.
+static TableSolver::Result
+merge_tables(const TableSolver::Result &ns, const TableSolver::Result &ew) {
+  TableSolver::Result table;
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      const TableSolver::Result &t = is_ns(seat) ? ns : ew;
+      table.set_tricks(strain, seat, t.tricks(strain, seat));
+    }
+  }
+  return table;
+}
+
+ParSolver::Results ParSolver::solve() {
+  int tricks_max = hands_.hand(FIRST_SEAT).count();
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    tpn_tables_[strain] = std::make_shared<TpnTable>();
+    tpn_tables_[strain]->enable_memory_budget(tpn_memory_budget_);
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      solvers_[strain][seat].reset();
+      lower_.set_tricks(strain, seat, 0);
+      upper_.set_tricks(strain, seat, tricks_max);
+    }
+  }
+
+  while (true) {
+    // Par is monotonic in every cell of the table, so the bounds on par are
+    // given by the bounds on the table most and least favorable to NS.
+    TableSolver::Result worst_ns = merge_tables(lower_, upper_);
+    TableSolver::Result best_ns  = merge_tables(upper_, lower_);
+
+    Results results;
+    bool    determined = true;
+    for (int vul = VUL_NONE; vul <= VUL_BOTH; vul++) {
+      Result lo = par(worst_ns, (Vulnerability)vul, dealer_);
+      Result hi = par(best_ns, (Vulnerability)vul, dealer_);
+      results[vul] = lo;
+
+      const Contract &c = lo.contract;
+      if (lo.score_ns != hi.score_ns) {
+        determined = false;
+      } else if (c.level > 0 && lower_.tricks(c.strain, c.declarer) !=
+                                    upper_.tricks(c.strain, c.declarer)) {
+        determined = false;
+      }
+    }
+    if (determined) {
+      return results;
+    }
+
+    // Refines the cell which may take the most tricks, skipping cells which
+    // cannot affect par as declarer's partner takes at least as many tricks.
+    auto priority = [&](Suit s, Seat seat) {
+      int  upper     = upper_.tricks(s, seat);
+      int  lower     = lower_.tricks(s, seat);
+      bool dominated = upper <= lower_.tricks(s, right_seat(seat, 2));
+      return std::tuple(!dominated, upper, upper - lower);
+    };
+    Suit strain   = NO_TRUMP;
+    Seat declarer = NO_SEAT;
+    for (Suit s = FIRST_SUIT; s <= NO_TRUMP; s++) {
+      for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+        if (lower_.tricks(s, seat) == upper_.tricks(s, seat)) {
+          continue;
+        }
+        if (declarer == NO_SEAT ||
+            priority(s, seat) > priority(strain, declarer)) {
+          strain   = s;
+          declarer = seat;
+        }
+      }
+    }
+    assert(declarer != NO_SEAT);
+    refine(strain, declarer);
+  }
+}
+
+void ParSolver::refine(Suit strain, Seat declarer) {
+  auto &solver = solvers_[strain][declarer];
+  if (!solver) {
+    solver.emplace(
+        Game(strain, right_seat(declarer), hands_), tpn_tables_[strain]
+    );
+  }
+
+  // Tests whether declarer takes at least the median number of tricks still
+  // possible, as a zero-window search on the number of tricks taken by NS.
+  int  lower      = lower_.tricks(strain, declarer);
+  int  upper      = upper_.tricks(strain, declarer);
+  int  target     = (lower + upper + 1) / 2;
+  int  tricks_max = solver->game().tricks_max();
+  bool ns         = is_ns(declarer);
+  int  beta       = ns ? target : tricks_max - target + 1;
+  int  r          = solver->solve(beta - 1, beta).tricks_taken_by_ns;
+
+  // The result bounds the tricks taken by NS from below if the search failed
+  // high, and from above otherwise.
+  int tricks = ns ? r : tricks_max - r;
+  if (ns == (r >= beta)) {
+    lower_.set_tricks(strain, declarer, std::max(lower, tricks));
+  } else {
+    upper_.set_tricks(strain, declarer, std::min(upper, tricks));
+  }
+}
+
+ParSolver::Result ParSolver::par(
+    const TableSolver::Result &table, Vulnerability vul, Seat dealer
+) {
+  // Scores are for NS, which NS (side 0) maximizes and EW (side 1) minimizes.
+  auto better = [](int side, int a, int b) {
+    return side == 0 ? a > b : a < b;
+  };
+  auto best = [&](int side, int a, int b) {
+    return better(side, b, a) ? b : a;
+  };
+
+  // Each side declares each strain from the seat taking the most tricks.
+  Seat declarers[2][5];
+  bool vulnerable[2] = {
+      vul == VUL_NS || vul == VUL_BOTH,
+      vul == VUL_EW || vul == VUL_BOTH,
+  };
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    declarers[0][strain] =
+        table.tricks(strain, SOUTH) > table.tricks(strain, NORTH) ? SOUTH
+                                                                  : NORTH;
+    declarers[1][strain] =
+        table.tricks(strain, EAST) > table.tricks(strain, WEST) ? EAST : WEST;
+  }
+
+  // The score when each side declares each contract, and the score reached
+  // once each side has bid each contract, with the other side to act. The
+  // other side either passes or outbids the contract, so values are found
+  // from the highest contract down.
+  int score[2][NUM_CONTRACTS];
+  int value[2][NUM_CONTRACTS];
+  int best_value[2] = {INT_MIN, INT_MAX};
+  for (int r = NUM_CONTRACTS - 1; r >= 0; r--) {
+    int  level  = r / 5 + 1;
+    Suit strain = (Suit)(r % 5);
+    for (int side = 0; side < 2; side++) {
+      Seat declarer  = declarers[side][strain];
+      int  tricks    = table.tricks(strain, declarer);
+      int  s         = contract_score(level, strain, tricks, vulnerable[side]);
+      score[side][r] = side == 0 ? s : -s;
+      value[side][r] = best(1 - side, score[side][r], best_value[1 - side]);
+    }
+    for (int side = 0; side < 2; side++) {
+      best_value[side] = best(side, best_value[side], value[side][r]);
+    }
+  }
+
+  // Follows the auction, preferring to pass (or bid the lowest contract)
+  // among equally good choices. The dealer's side bids first.
+  int d = is_ns(dealer) ? 0 : 1;
+  int e = 1 - d;
+  int side, r = 0;
+  if (better(d, best_value[d], best(e, 0, best_value[e]))) {
+    side = d;
+  } else if (better(e, best_value[e], 0)) {
+    side = e;
+  } else {
+    return {.contract = {0, NO_TRUMP, NO_SEAT, false}, .score_ns = 0};
+  }
+  while (value[side][r] != best_value[side]) {
+    r++;
+  }
+
+  while (true) {
+    int other  = 1 - side;
+    int best_r = -1;
+    for (int r2 = r + 1; r2 < NUM_CONTRACTS; r2++) {
+      if (best_r < 0 ||
+          better(other, value[other][r2], value[other][best_r])) {
+        best_r = r2;
+      }
+    }
+    if (best_r < 0 || !better(other, value[other][best_r], score[side][r])) {
+      break;
+    }
+    side = other;
+    r    = best_r;
+  }
+
+  // A making contract is reported at the highest level with the same score,
+  // e.g., 3♠ rather than 1♠ when declarer takes nine tricks.
+  Suit strain   = (Suit)(r % 5);
+  Seat declarer = declarers[side][strain];
+  while (r + 5 < NUM_CONTRACTS && score[side][r + 5] == score[side][r] &&
+         table.tricks(strain, declarer) >= r / 5 + 8) {
+    r += 5;
+  }
+
+  int level = r / 5 + 1;
+  assert(score[side][r] == best(d, best(e, 0, best_value[e]), best_value[d]));
+  return {
+      .contract =
+          {
+              .level    = level,
+              .strain   = strain,
+              .declarer = declarer,
+              .doubled  = table.tricks(strain, declarer) < level + 6,
+          },
+      .score_ns = score[side][r],
+  };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+
+#include "game_model.h"
+#include "solver.h"
+#include "table_solver.h"
+
+enum Vulnerability {
+  VUL_NONE,
+  VUL_NS,
+  VUL_EW,
+  VUL_BOTH,
+};
+
+// Returns declarer's score for a contract at the given level (1-7) and strain,
+// given the number of tricks taken by declarer. Contracts which fail are
+// scored doubled, as they are when computing par.
+int contract_score(int level, Suit strain, int tricks, bool vulnerable);
+
+// Computes the par result of a deal: the result when both sides bid optimally
+// with knowledge of the double dummy table, making contracts are played
+// undoubled and failing contracts are played doubled.
+//
+// Rather than solving the full table, each cell of the table is bounded using
+// zero-window searches, only as far as necessary to determine par. Cells for
+// a declarer whose partner is known to take at least as many tricks are never
+// refined.
+class ParSolver {
+public:
+  struct Contract {
+    int  level; // Zero if the deal is passed out.
+    Suit strain;
+    Seat declarer;
+    bool doubled;
+  };
+
+  struct Result {
+    Contract contract;
+    int      score_ns;
+  };
+
+  // Results indexed by vulnerability.
+  using Results = std::array<Result, 4>;
+
+  ParSolver(const Hands &hands, Seat dealer);
+
+  Solver::Stats stats() const;
+
+  // Bounds the memory used by the transposition table for each strain.
+  void enable_tpn_memory_budget(int64_t max_bytes);
+
+  Results solve();
+
+  // Computes par from a (complete) double dummy table.
+  static Result
+  par(const TableSolver::Result &table, Vulnerability vul, Seat dealer);
+
+private:
+  void refine(Suit strain, Seat declarer);
+
+  Hands                     hands_;
+  Seat                      dealer_;
+  int64_t                   tpn_memory_budget_;
+  std::shared_ptr<TpnTable> tpn_tables_[5];
+  std::optional<Solver>     solvers_[5][4];
+  TableSolver::Result       lower_;
+  TableSolver::Result       upper_;
+};
+
+// ----------------------
+// Implementation Details
+// ----------------------
+
+template <> struct std::formatter<ParSolver::Result> {
+  constexpr auto parse(auto &ctx) { return ctx.begin(); }
+
+  auto format(const ParSolver::Result &result, auto &ctx) const {
+    const ParSolver::Contract &c = result.contract;
+    if (c.level == 0) {
+      return std::format_to(ctx.out(), "pass {}", result.score_ns);
+    }
+    return std::format_to(
+        ctx.out(),
+        "{}{}{} {} {}",
+        c.level,
+        suit_to_ascii(c.strain),
+        c.doubled ? "X" : "",
+        c.declarer,
+        result.score_ns
+    );
+  }
+};
@@ -0,0 +1,23 @@
+#include "parallel_solver.h"
+
+ParallelSolver::ParallelSolver(Game g, int num_threads)
+    : pool_(std::make_unique<ThreadPool>(std::max(1, num_threads) - 1)),
+      solver_(g, std::make_shared<TpnTable>(TpnTable::CONCURRENT_SHARDS)) {
+  solver_.enable_parallel_search(pool_.get(), DEFAULT_SPLIT_MIN_TRICKS);
+}
+
+Solver::Stats ParallelSolver::stats() const { return solver_.stats(); }
+
+void ParallelSolver::enable_split_min_tricks(int split_min_tricks) {
+  solver_.enable_parallel_search(pool_.get(), split_min_tricks);
+}
+
+void ParallelSolver::reset(Game g, Solver::ResetPolicy policy) {
+  solver_.reset(std::move(g), policy);
+}
+
+Solver::Result ParallelSolver::solve() { return solver_.solve(); }
+
+Solver::Result ParallelSolver::solve(int alpha, int beta) {
+  return solver_.solve(alpha, beta);
+}
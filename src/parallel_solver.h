@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include "game_model.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+// Solves a single game using several threads with a "young brothers wait"
+// parallel search. At each node with enough tricks left, the first (best
+// ordered) play is searched serially, after which the remaining plays are
+// searched in parallel by a work-stealing thread pool. Plays searched in
+// parallel share alpha/beta bounds, and are abandoned on a cutoff.
+class ParallelSolver {
+public:
+  // Nodes with fewer tricks left are always searched serially.
+  static constexpr int DEFAULT_SPLIT_MIN_TRICKS = 5;
+
+  ParallelSolver(Game g, int num_threads);
+
+  Solver::Stats stats() const;
+  TpnTable     &tpn_table() { return solver_.tpn_table(); }
+
+  void enable_split_min_tricks(int split_min_tricks);
+
+  // Rebinds the solver to a new game (see Solver::reset). The thread pool is
+  // kept running.
+  void reset(Game g, Solver::ResetPolicy policy = Solver::CLEAR_TPN_TABLE);
+
+  Solver::Result solve();
+  Solver::Result solve(int alpha, int beta);
+
+private:
+  std::unique_ptr<ThreadPool> pool_;
+  Solver                      solver_;
+};
@@ -1,3 +1,5 @@
+#include <climits>
+
 #include "play_order.h"
 #include "card_model.h"
 
@@ -28,6 +30,14 @@ void PlayOrder::append_plays(Cards cards, bool low_to_high) {
   }
 }
 
+void PlayOrder::perturb(uint64_t bits) {
+  for (int i = 0; i + 1 < card_count_; i++, bits >>= 1) {
+    if (bits & 1) {
+      std::swap(cards_[i], cards_[i + 1]);
+    }
+  }
+}
+
 static Cards compute_sure_winners(
     const Trick &trick, const Hands &hands, Cards valid_plays
 ) {
@@ -157,9 +167,97 @@ private:
   int8_t       length_[4][4];
 };
 
-void order_plays(const Game &game, PlayOrder &order) {
+PlayHistory::PlayHistory() { clear(); }
+
+void PlayHistory::clear() {
+  for (auto &by_position : history_) {
+    for (auto &by_card : by_position) {
+      by_card.fill(0);
+    }
+  }
+  for (auto &by_position : killers_) {
+    by_position.fill(NO_CARD);
+  }
+}
+
+void PlayHistory::add_cutoff(const Game &game, Card card) {
+  int position = game.current_trick().card_count() - 1;
+  if (position < 0) {
+    return;
+  }
+  int      tricks_left = game.tricks_left();
+  int32_t &score =
+      history_[game.next_seat()][position][game.normalize_card(card).index()];
+  score += tricks_left * tricks_left;
+  killers_[tricks_left][position] = (int8_t)card.index();
+
+  // Ages the history before scores can overflow.
+  if (score > (1 << 30)) {
+    for (auto &by_position : history_) {
+      for (auto &by_card : by_position) {
+        for (int32_t &s : by_card) {
+          s /= 2;
+        }
+      }
+    }
+  }
+}
+
+int PlayHistory::score(const Game &game, Card card) const {
+  int position = game.current_trick().card_count() - 1;
+  return history_[game.next_seat()][position]
+                 [game.normalize_card(card).index()];
+}
+
+bool PlayHistory::is_killer(const Game &game, Card card) const {
+  int position = game.current_trick().card_count() - 1;
+  return killers_[game.tricks_left()][position] == card.index();
+}
+
+// Appends plays ranked equally by the static rules, from low to high. Plays of
+// the same rank (i.e., discards from different suits) are ordered by the
+// history, if any: the killer play first, then by history score.
+static void append_learned_plays(
+    const Game &game, PlayOrder &order, Cards cards, const PlayHistory *history
+) {
+  if (!history) {
+    order.append_plays(cards, PlayOrder::LOW_TO_HIGH);
+    return;
+  }
+
+  // Insertion sort by descending key, where lower ranks have higher keys.
+  Card    plays[13];
+  int64_t keys[13];
+  int     n = 0;
+  for (Card c : cards.low_to_high()) {
+    int64_t key = history->is_killer(game, c) ? INT32_MAX
+                                              : history->score(game, c);
+    key -= (int64_t)c.rank() << 32;
+    int i = n++;
+    for (; i > 0 && keys[i - 1] < key; i--) {
+      plays[i] = plays[i - 1];
+      keys[i]  = keys[i - 1];
+    }
+    plays[i] = c;
+    keys[i]  = key;
+  }
+  for (int i = 0; i < n; i++) {
+    order.append_play(plays[i]);
+  }
+}
+
+void order_plays(
+    const Game         &game,
+    PlayOrder          &order,
+    const PlayHistory  *history,
+    std::optional<Card> hint
+) {
   auto &trick = game.current_trick();
 
+  if (hint && game.valid_plays_pruned().contains(*hint)) {
+    order.append_play(*hint);
+  }
+
   if (!trick.started()) {
     LeadAnalyzer analyzer(game, order);
     analyzer.compute_order();
@@ -169,12 +267,14 @@ void order_plays(const Game &game, PlayOrder &order) {
   Cards valid_plays  = game.valid_plays_pruned();
   Cards sure_winners = compute_sure_winners(trick, game.hands(), valid_plays);
   order.append_plays(sure_winners, PlayOrder::LOW_TO_HIGH);
+  valid_plays.remove_all(sure_winners);
 
   if (trick.trump_suit() != NO_TRUMP) {
     Cards non_trump_losers =
         valid_plays.without_all(Cards::all(trick.trump_suit()));
-    order.append_plays(non_trump_losers, PlayOrder::LOW_TO_HIGH);
+    append_learned_plays(game, order, non_trump_losers, history);
+    valid_plays.remove_all(non_trump_losers);
   }
 
-  order.append_plays(valid_plays, PlayOrder::LOW_TO_HIGH);
-}
\ No newline at end of file
+  append_learned_plays(game, order, valid_plays, history);
+}
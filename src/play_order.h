@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <optional>
+
 #include "card_model.h"
 #include "game_model.h"
 
@@ -15,6 +18,7 @@ public:
 
   void append_plays(Cards cards, bool low_to_high);
   void append_play(Card card);
+  void perturb(uint64_t bits);
 
 private:
   friend class Iter;
@@ -24,4 +28,39 @@ private:
   int8_t card_count_;
 };
 
-void order_plays(const Game &game, PlayOrder &order);
+// Learns from the cutoffs found by a search, to order follows and discards
+// (i.e., plays after the lead). The history scores each play which caused a
+// cutoff by seat, position in the trick and normalized card, weighted towards
+// cutoffs with more tricks left, while the killer play is the latest play to
+// cause a cutoff with the same number of tricks left and position.
+class PlayHistory {
+public:
+  PlayHistory();
+
+  // Records a play which caused a cutoff at the given position.
+  void add_cutoff(const Game &game, Card card);
+  void clear();
+
+  int  score(const Game &game, Card card) const;
+  bool is_killer(const Game &game, Card card) const;
+
+private:
+  static constexpr int8_t NO_CARD = -1;
+
+  // Indexed by seat, then by position after the lead (0-2).
+  std::array<std::array<std::array<int32_t, 52>, 3>, 4> history_;
+  // Indexed by tricks left, then by position after the lead (0-2).
+  std::array<std::array<int8_t, 3>, 14>                 killers_;
+};
+
+// Orders the valid plays, with the plays most likely to cause a cutoff first.
+// The given hint (e.g., the best play found by an earlier search) is tried
+// first, if it is a valid play. The lead is otherwise ordered by static rules
+// alone. Follows and discards are ordered by static rules, then from low to
+// high, with discards of the same rank ordered by the given history, if any.
+void order_plays(
+    const Game         &game,
+    PlayOrder          &order,
+    const PlayHistory  *history = nullptr,
+    std::optional<Card> hint    = std::nullopt
+);
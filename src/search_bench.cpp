@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <format>
+#include <map>
+#include <stdexcept>
+
+#include "parser.h"
+#include "search_bench.h"
+#include "solver.h"
+
+void BenchMetrics::add(const BenchMetrics &metrics) {
+  deals += metrics.deals;
+  nodes_explored += metrics.nodes_explored;
+  elapsed_us += metrics.elapsed_us;
+  tpn_stats.buckets += metrics.tpn_stats.buckets;
+  tpn_stats.entries += metrics.tpn_stats.entries;
+  tpn_stats.bytes = std::max(tpn_stats.bytes, metrics.tpn_stats.bytes);
+  tpn_stats.evicted_buckets += metrics.tpn_stats.evicted_buckets;
+  tpn_stats.add_counters(metrics.tpn_stats);
+  search_counters.add(metrics.search_counters);
+}
+
+double BenchMetrics::nodes_per_sec() const {
+  return nodes_explored * 1e6 / std::max(elapsed_us, (int64_t)1);
+}
+
+// The metrics written to (and read from) JSON, by name.
+static std::array<std::pair<std::string_view, int64_t *>, 13>
+metric_fields(BenchMetrics &m) {
+  return {{
+      {"deals", &m.deals},
+      {"nodes_explored", &m.nodes_explored},
+      {"elapsed_us", &m.elapsed_us},
+      {"tpn_buckets", &m.tpn_stats.buckets},
+      {"tpn_entries", &m.tpn_stats.entries},
+      {"tpn_peak_bytes", &m.tpn_stats.bytes},
+      {"tpn_evicted", &m.tpn_stats.evicted_buckets},
+      {"tpn_lookup_hits", &m.tpn_stats.lookup_hits},
+      {"tpn_lookup_misses", &m.tpn_stats.lookup_misses},
+      {"tpn_lookup_reads", &m.tpn_stats.lookup_reads},
+      {"tpn_insert_hits", &m.tpn_stats.insert_hits},
+      {"tpn_insert_misses", &m.tpn_stats.insert_misses},
+      {"tpn_insert_reads", &m.tpn_stats.insert_reads},
+  }};
+}
+
+static constexpr std::string_view TYPE_NAMES[] = {"deal", "group", "total"};
+
+// Writes the counters for each depth searched, from the first trick to the
+// last, as an array of objects.
+static void
+format_search_counters(std::string &json, const SearchCounters &counters) {
+  auto out = std::back_inserter(json);
+  json += ",\"search_counters\":[";
+  bool first = true;
+  for (int tricks = 13; tricks >= 0; tricks--) {
+    for (int pos = 0; pos < 4; pos++) {
+      const SearchCounters::Depth &d = counters.depths[tricks][pos];
+      if (d.empty()) {
+        continue;
+      }
+      std::format_to(
+          out,
+          "{}{{\"tricks_left\":{},\"position\":{},\"nodes\":{},"
+          "\"tpn_lookups\":{},\"tpn_hits\":{},\"tpn_inserts\":{},"
+          "\"ft_cutoffs\":{},\"ct_cutoffs\":{},\"branching_factor\":{:.2f},"
+          "\"terminals\":{}}}",
+          first ? "" : ",",
+          tricks,
+          pos + 1,
+          d.nodes,
+          d.tpn_lookups,
+          d.tpn_hits,
+          d.tpn_inserts,
+          d.ft_cutoffs,
+          d.ct_cutoffs,
+          d.branching_factor(),
+          d.terminals
+      );
+      first = false;
+    }
+  }
+  json += ']';
+}
+
+// Names, games and groups never need escaping, so strings are written as is.
+std::string BenchRecord::to_json() const {
+  std::string json = std::format(
+      "{{\"type\":\"{}\",\"name\":\"{}\"", TYPE_NAMES[type], name
+  );
+  auto out = std::back_inserter(json);
+  if (type == DEAL) {
+    std::format_to(
+        out, ",\"group\":\"{}\",\"tricks_ns\":{}", group, tricks_taken_by_ns
+    );
+  }
+  BenchMetrics m = metrics;
+  for (auto [field, value] : metric_fields(m)) {
+    std::format_to(out, ",\"{}\":{}", field, *value);
+  }
+  std::format_to(out, ",\"nodes_per_sec\":{:.0f}", m.nodes_per_sec());
+  if constexpr (SearchCounters::ENABLED) {
+    format_search_counters(json, m.search_counters);
+  }
+  json += '}';
+  return json;
+}
+
+static std::string parse_json_string(Parser &parser) {
+  if (!parser.try_parse('"')) {
+    throw parser.error("expected string");
+  }
+  std::string s;
+  while (!parser.finished() && parser.peek() != '"') {
+    if (parser.peek() == '\\') {
+      throw parser.error("unsupported escape");
+    }
+    s += parser.peek();
+    parser.try_parse(parser.peek());
+  }
+  if (!parser.try_parse('"')) {
+    throw parser.error("unterminated string");
+  }
+  return s;
+}
+
+// Skips an array or object, returning its text.
+static std::string skip_json_nested(Parser &parser) {
+  std::string s;
+  int         depth = 0;
+  do {
+    if (parser.finished()) {
+      throw parser.error("unterminated array or object");
+    }
+    char c = parser.peek();
+    if (c == '[' || c == '{') {
+      depth++;
+    } else if (c == ']' || c == '}') {
+      depth--;
+    }
+    s += c;
+    parser.try_parse(c);
+  } while (depth > 0);
+  return s;
+}
+
+static std::string parse_json_number(Parser &parser) {
+  std::string s;
+  while (!parser.finished() &&
+         (std::isdigit(parser.peek()) || parser.peek() == '-' ||
+          parser.peek() == '.' || parser.peek() == 'e')) {
+    s += parser.peek();
+    parser.try_parse(parser.peek());
+  }
+  if (s.empty()) {
+    throw parser.error("expected number");
+  }
+  return s;
+}
+
+// Parses a JSON object of strings and numbers, as written by to_json. Nested
+// arrays and objects are skipped.
+BenchRecord BenchRecord::from_json(std::string_view line) {
+  Parser                             parser(line);
+  std::map<std::string, std::string> values;
+  parser.skip_whitespace();
+  if (!parser.try_parse('{')) {
+    throw parser.error("expected '{'");
+  }
+  parser.skip_whitespace();
+  while (!parser.try_parse('}')) {
+    if (!values.empty() && !parser.try_parse(',')) {
+      throw parser.error("expected ','");
+    }
+    parser.skip_whitespace();
+    std::string key = parse_json_string(parser);
+    parser.skip_whitespace();
+    if (!parser.try_parse(':')) {
+      throw parser.error("expected ':'");
+    }
+    parser.skip_whitespace();
+    char next = parser.finished() ? '\0' : parser.peek();
+    if (next == '"') {
+      values[key] = parse_json_string(parser);
+    } else if (next == '[' || next == '{') {
+      values[key] = skip_json_nested(parser);
+    } else {
+      values[key] = parse_json_number(parser);
+    }
+    parser.skip_whitespace();
+  }
+
+  BenchRecord record;
+  auto        type = std::find(
+      std::begin(TYPE_NAMES), std::end(TYPE_NAMES), values["type"]
+  );
+  if (type == std::end(TYPE_NAMES)) {
+    throw std::runtime_error(
+        std::format("unknown record type: {}", values["type"])
+    );
+  }
+  record.type  = (Type)(type - std::begin(TYPE_NAMES));
+  record.name  = values["name"];
+  record.group = values["group"];
+  if (values.contains("tricks_ns")) {
+    record.tricks_taken_by_ns = std::stoi(values["tricks_ns"]);
+  }
+  for (auto [field, value] : metric_fields(record.metrics)) {
+    auto it = values.find(std::string(field));
+    if (it != values.end()) {
+      *value = std::stoll(it->second);
+    }
+  }
+  return record;
+}
+
+std::vector<BenchRecord>
+run_search_bench(const std::vector<Game> &games, int64_t tpn_memory_budget) {
+  std::vector<BenchRecord>                    records;
+  std::map<std::pair<int, Suit>, BenchRecord> groups;
+  BenchRecord                                 total;
+  total.type = BenchRecord::TOTAL;
+  total.name = "total";
+
+  for (const Game &g : games) {
+    Solver s(g);
+    s.tpn_table().enable_memory_budget(tpn_memory_budget);
+
+    auto begin = std::chrono::steady_clock::now();
+    auto r     = s.solve();
+    auto end   = std::chrono::steady_clock::now();
+    auto stats = s.stats();
+
+    BenchRecord deal;
+    deal.type = BenchRecord::DEAL;
+    deal.name = std::format(
+        "{} {} {}", suit_to_ascii(g.trump_suit()), g.lead_seat(), g.hands()
+    );
+    deal.group =
+        std::format("{}{}", g.tricks_left(), suit_to_ascii(g.trump_suit()));
+    deal.tricks_taken_by_ns     = r.tricks_taken_by_ns;
+    deal.metrics.deals          = 1;
+    deal.metrics.nodes_explored = stats.nodes_explored;
+    deal.metrics.elapsed_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - begin)
+            .count();
+    deal.metrics.tpn_stats       = stats.tpn_table_stats;
+    deal.metrics.search_counters = stats.search_counters;
+
+    BenchRecord &group = groups[{g.tricks_left(), g.trump_suit()}];
+    group.type         = BenchRecord::GROUP;
+    group.name         = deal.group;
+    group.metrics.add(deal.metrics);
+    total.metrics.add(deal.metrics);
+    records.push_back(std::move(deal));
+  }
+
+  for (auto &[key, group] : groups) {
+    records.push_back(std::move(group));
+  }
+  records.push_back(std::move(total));
+  return records;
+}
+
+static void check_growth(
+    std::vector<BenchRegression> &regressions,
+    const std::string            &name,
+    std::string_view              metric,
+    int64_t                       baseline,
+    int64_t                       current,
+    double                        threshold
+) {
+  if ((double)current > (double)baseline * (1 + threshold)) {
+    regressions.push_back({name, std::string(metric), baseline, current});
+  }
+}
+
+std::vector<BenchRegression> compare_search_bench(
+    const std::vector<BenchRecord> &baseline,
+    const std::vector<BenchRecord> &current,
+    double                          threshold
+) {
+  std::map<std::string, const BenchRecord *> baseline_by_name;
+  for (const BenchRecord &record : baseline) {
+    baseline_by_name[record.name] = &record;
+  }
+
+  std::vector<BenchRegression> regressions;
+  for (const BenchRecord &record : current) {
+    auto it = baseline_by_name.find(record.name);
+    if (it == baseline_by_name.end() || it->second->type != record.type) {
+      continue;
+    }
+    const BenchRecord &base = *it->second;
+    if (record.type == BenchRecord::DEAL &&
+        record.tricks_taken_by_ns != base.tricks_taken_by_ns) {
+      regressions.push_back(
+          {record.name,
+           "tricks_ns",
+           base.tricks_taken_by_ns,
+           record.tricks_taken_by_ns}
+      );
+    }
+    check_growth(
+        regressions,
+        record.name,
+        "nodes_explored",
+        base.metrics.nodes_explored,
+        record.metrics.nodes_explored,
+        threshold
+    );
+    // The time taken by a single deal is too noisy to compare.
+    if (record.type != BenchRecord::DEAL) {
+      check_growth(
+          regressions,
+          record.name,
+          "elapsed_us",
+          base.metrics.elapsed_us,
+          record.metrics.elapsed_us,
+          threshold
+      );
+    }
+  }
+  return regressions;
+}
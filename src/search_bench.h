@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game_model.h"
+#include "search_counters.h"
+#include "tpn_table.h"
+
+// Measures of the search's efficiency, for one deal or summed over a group of
+// deals.
+struct BenchMetrics {
+  int64_t         deals          = 0;
+  int64_t         nodes_explored = 0;
+  int64_t         elapsed_us     = 0;
+  // The table's counters. As the table never releases memory while solving,
+  // its allocated bytes are also its peak size. Summed metrics keep the
+  // largest peak of any deal.
+  TpnTable::Stats tpn_stats;
+  // Written only when built with DUMDUM_SEARCH_COUNTERS, and not read back.
+  SearchCounters  search_counters;
+
+  void   add(const BenchMetrics &metrics);
+  double nodes_per_sec() const;
+};
+
+// The result of a benchmark, for a deal (named by the game in the text format),
+// a group of deals of the same size and strain (e.g., "13NT"), or the whole
+// corpus ("total").
+struct BenchRecord {
+  enum Type {
+    DEAL,
+    GROUP,
+    TOTAL,
+  };
+
+  Type         type;
+  std::string  name;
+  std::string  group;
+  int          tricks_taken_by_ns = -1; // deals only
+  BenchMetrics metrics;
+
+  // Records are written as one line of JSON each.
+  std::string to_json() const;
+  static BenchRecord from_json(std::string_view line);
+};
+
+// Solves each game with a new solver, so that every deal starts from an empty
+// table, returning a record for each game, then for each group (ordered by
+// size and strain), then for the whole corpus.
+std::vector<BenchRecord>
+run_search_bench(const std::vector<Game> &games, int64_t tpn_memory_budget);
+
+struct BenchRegression {
+  std::string name;
+  std::string metric;
+  int64_t     baseline;
+  int64_t     current;
+};
+
+// Compares records with the records of a baseline run, matching them by name.
+// Reports each deal whose result changed or whose nodes explored grew by more
+// than the threshold (e.g., 0.05 for 5%), and each group, or the total, whose
+// nodes explored or elapsed time grew by more than the threshold. Records
+// missing from the baseline are ignored.
+std::vector<BenchRegression> compare_search_bench(
+    const std::vector<BenchRecord> &baseline,
+    const std::vector<BenchRecord> &current,
+    double                          threshold
+);
@@ -0,0 +1,29 @@
+#include "search_counters.h"
+
+void SearchCounters::Depth::add(const Depth &depth) {
+  nodes += depth.nodes;
+  tpn_lookups += depth.tpn_lookups;
+  tpn_hits += depth.tpn_hits;
+  tpn_inserts += depth.tpn_inserts;
+  ft_cutoffs += depth.ft_cutoffs;
+  ct_cutoffs += depth.ct_cutoffs;
+  plays += depth.plays;
+  terminals += depth.terminals;
+}
+
+bool SearchCounters::Depth::empty() const {
+  return nodes == 0 && tpn_lookups == 0 && ft_cutoffs == 0 &&
+         ct_cutoffs == 0 && terminals == 0;
+}
+
+double SearchCounters::Depth::branching_factor() const {
+  return nodes > 0 ? (double)plays / nodes : 0;
+}
+
+void SearchCounters::add(const SearchCounters &counters) {
+  for (std::size_t i = 0; i < depths.size(); i++) {
+    for (std::size_t j = 0; j < depths[i].size(); j++) {
+      depths[i][j].add(counters.depths[i][j]);
+    }
+  }
+}
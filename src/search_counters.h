@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "game_model.h"
+
+// Counters of the work done by the search, broken down by the number of
+// tricks left and by the position of the next play in the trick. Counting is
+// only compiled in when DUMDUM_SEARCH_COUNTERS is defined (by the CMake option
+// of the same name), so that it costs nothing otherwise.
+struct SearchCounters {
+#ifdef DUMDUM_SEARCH_COUNTERS
+  static constexpr bool ENABLED = true;
+#else
+  static constexpr bool ENABLED = false;
+#endif
+
+  struct Depth {
+    int64_t nodes       = 0;
+    int64_t tpn_lookups = 0;
+    int64_t tpn_hits    = 0;
+    int64_t tpn_inserts = 0;
+    int64_t ft_cutoffs  = 0;
+    // Cutoffs by the decided current trick, in the middle of a trick.
+    int64_t ct_cutoffs  = 0;
+    // The plays at each node after pruning equivalent plays (whether or not
+    // they were searched before a cutoff), summed over all nodes.
+    int64_t plays       = 0;
+    int64_t terminals   = 0;
+
+    void   add(const Depth &depth);
+    // Whether no position was searched at this depth.
+    bool   empty() const;
+    // The average number of plays at each node.
+    double branching_factor() const;
+  };
+
+  // Indexed by tricks left, then by position in the trick (0 for the lead).
+  std::array<std::array<Depth, 4>, 14> depths;
+
+  Depth &depth(const Game &g) {
+    return depths[g.tricks_left()][g.current_trick().card_count()];
+  }
+
+  void add(const SearchCounters &counters);
+};
@@ -0,0 +1,408 @@
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "server.h"
+#include "solver.h"
+#include "table_solver.h"
+
+struct Server::Worker {
+  std::optional<Solver> solver;
+};
+
+// A stream of requests, whose responses are written in request order.
+// Responses which complete early are held until all earlier responses have
+// been written.
+// A stream of requests, whose responses are written in request order by the
+// client's own writer thread, so that workers never wait on a client which is
+// slow to read. Responses which complete early are held until all earlier
+// responses have been written.
+struct Server::Client {
+  std::function<void(const std::string &)> write;
+  std::mutex                               mutex;
+  std::condition_variable                  cv;
+  int64_t                                  num_requests   = 0;
+  int64_t                                  next_write_seq = 0;
+  bool                                     reading        = true;
+  std::map<int64_t, std::string>           pending;
+};
+
+// Number of requests per worker which may be read ahead of the workers.
+static constexpr int MAX_QUEUED_PER_WORKER = 4;
+// Number of requests per client which may be read ahead of the client reading
+// their responses.
+static constexpr int MAX_UNWRITTEN_PER_CLIENT = 64;
+
+Server::Server() : num_threads_(1), tpn_memory_budget_(0), stop_(false) {}
+
+Server::~Server() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queued_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void Server::enable_threads(int num_threads) {
+  num_threads_ = std::max(1, num_threads);
+}
+
+void Server::enable_tpn_memory_budget(int64_t max_bytes) {
+  tpn_memory_budget_ = max_bytes;
+}
+
+void Server::serve(std::istream &in, std::ostream &out) {
+  serve(
+      [&](std::string &line) { return (bool)std::getline(in, line); },
+      [&](const std::string &response) { out << response << std::flush; }
+  );
+}
+
+void Server::serve(
+    std::function<bool(std::string &)>        read_line,
+    std::function<void(const std::string &)> write
+) {
+  Client client;
+  client.write = std::move(write);
+
+  // Writes responses until all requests have been read and answered.
+  std::thread writer([&client]() {
+    std::unique_lock<std::mutex> lock(client.mutex);
+    while (true) {
+      client.cv.wait(lock, [&]() {
+        bool next_answered = !client.pending.empty() &&
+                             client.pending.begin()->first ==
+                                 client.next_write_seq;
+        bool done = !client.reading &&
+                    client.next_write_seq == client.num_requests;
+        return next_answered || done;
+      });
+      if (client.next_write_seq == client.num_requests) {
+        return;
+      }
+      std::string response = std::move(client.pending.begin()->second);
+      client.pending.erase(client.pending.begin());
+      lock.unlock();
+      client.write(response);
+      lock.lock();
+      client.next_write_seq++;
+      client.cv.notify_all();
+    }
+  });
+
+  std::string line;
+  while (read_line(line)) {
+    int64_t seq;
+    {
+      std::unique_lock<std::mutex> lock(client.mutex);
+      client.cv.wait(lock, [&]() {
+        return client.num_requests - client.next_write_seq <
+               MAX_UNWRITTEN_PER_CLIENT;
+      });
+      seq = client.num_requests++;
+    }
+    submit({.client = &client, .seq = seq, .line = line});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(client.mutex);
+    client.reading = false;
+  }
+  client.cv.notify_all();
+  // The client must outlive the responses to all of its requests.
+  writer.join();
+}
+
+void Server::submit(Request request) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (threads_.empty()) {
+    for (int i = 0; i < num_threads_; i++) {
+      threads_.emplace_back(&Server::work, this);
+    }
+  }
+  space_cv_.wait(lock, [&]() {
+    return queue_.size() < MAX_QUEUED_PER_WORKER * threads_.size();
+  });
+  queue_.push_back(std::move(request));
+  lock.unlock();
+  queued_cv_.notify_one();
+}
+
+void Server::work() {
+  Worker w;
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_cv_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    space_cv_.notify_one();
+
+    std::string response = answer(request.seq, request.line, w);
+
+    // Notify while locked, as the client may go away once unlocked.
+    Client                     &client = *request.client;
+    std::lock_guard<std::mutex> lock(client.mutex);
+    client.pending.emplace(request.seq, std::move(response));
+    client.cv.notify_all();
+  }
+}
+
+static void append_json_string(std::string &out, std::string_view s) {
+  out += '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if ((unsigned char)c < 0x20) {
+      std::format_to(std::back_inserter(out), "\\u{:04x}", (int)c);
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+static std::string card_to_ascii(Card c) {
+  return std::format("{}{}", c.rank(), suit_to_ascii(c.suit()));
+}
+
+// Parses a number of tricks, from 0 to 13.
+static int parse_tricks(Parser &parser) {
+  if (parser.finished() || !std::isdigit(parser.peek())) {
+    throw parser.error("expected number");
+  }
+  int n = 0;
+  while (!parser.finished() && std::isdigit(parser.peek())) {
+    n = n * 10 + (parser.peek() - '0');
+    if (n > 13) {
+      throw parser.error("expected number of tricks (at most 13)");
+    }
+    parser.try_parse(parser.peek());
+  }
+  return n;
+}
+
+std::string
+Server::answer(int64_t seq, const std::string &request, Worker &worker) {
+  std::string response = std::format("{{\"seq\":{}", seq);
+  auto        out      = std::back_inserter(response);
+  auto        begin    = std::chrono::steady_clock::now();
+
+  auto solver = [&](const Game &g) -> Solver & {
+    if (worker.solver) {
+      worker.solver->reset(g);
+    } else {
+      worker.solver.emplace(g);
+    }
+    worker.solver->tpn_table().enable_memory_budget(tpn_memory_budget_);
+    return *worker.solver;
+  };
+
+  int64_t nodes_explored = 0;
+  try {
+    Parser parser(request);
+    parser.skip_whitespace();
+    if (parser.try_parse("table")) {
+      parser.skip_whitespace();
+      Hands hands(parser);
+      parser.skip_whitespace();
+      if (!parser.finished()) {
+        throw parser.error("unexpected input after hands");
+      }
+      TableSolver s(hands);
+      s.enable_tpn_memory_budget(tpn_memory_budget_);
+      auto r = s.solve();
+      std::format_to(out, ",\"table\":{{");
+      for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+        std::format_to(
+            out,
+            "{}\"{}\":[{},{},{},{}]",
+            strain == FIRST_SUIT ? "" : ",",
+            suit_to_ascii(strain),
+            r.tricks(strain, WEST),
+            r.tricks(strain, NORTH),
+            r.tricks(strain, EAST),
+            r.tricks(strain, SOUTH)
+        );
+      }
+      std::format_to(out, "}}");
+      nodes_explored = s.stats().nodes_explored;
+    } else if (parser.try_parse("plays")) {
+      parser.skip_whitespace();
+      Solver                         &s = solver(Game(parser));
+      std::vector<Solver::PlayResult> plays;
+      auto                            r = s.solve_all_plays(plays);
+      std::format_to(
+          out,
+          ",\"tricks_ns\":{},\"tricks_ew\":{},\"plays\":{{",
+          r.tricks_taken_by_ns,
+          r.tricks_taken_by_ew
+      );
+      for (std::size_t i = 0; i < plays.size(); i++) {
+        std::format_to(
+            out,
+            "{}\"{}\":{}",
+            i == 0 ? "" : ",",
+            card_to_ascii(plays[i].card),
+            plays[i].tricks_taken_by_ns
+        );
+      }
+      std::format_to(out, "}}");
+      nodes_explored = s.stats().nodes_explored;
+    } else if (parser.try_parse("bound")) {
+      parser.skip_whitespace();
+      int bound = parse_tricks(parser);
+      parser.skip_whitespace();
+      Solver &s = solver(Game(parser));
+      auto    r = s.solve(bound - 1, bound);
+      std::format_to(
+          out,
+          ",\"bound\":{},\"at_least\":{}",
+          bound,
+          r.tricks_taken_by_ns >= bound
+      );
+      nodes_explored = s.stats().nodes_explored;
+    } else {
+      parser.try_parse("solve");
+      parser.skip_whitespace();
+      Solver &s = solver(Game(parser));
+      auto    r = s.solve();
+      std::format_to(
+          out,
+          ",\"tricks_ns\":{},\"tricks_ew\":{}",
+          r.tricks_taken_by_ns,
+          r.tricks_taken_by_ew
+      );
+      nodes_explored = s.stats().nodes_explored;
+    }
+  } catch (const std::exception &err) {
+    response = std::format("{{\"seq\":{},\"error\":", seq);
+    append_json_string(response, err.what());
+    response += "}\n";
+    return response;
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count();
+  std::format_to(
+      out,
+      ",\"nodes_explored\":{},\"elapsed_ms\":{}}}\n",
+      nodes_explored,
+      elapsed_ms
+  );
+  return response;
+}
+
+void Server::serve_unix_socket(const std::string &path) {
+#ifdef _WIN32
+  throw std::runtime_error("Unix domain sockets are not supported");
+#else
+  sockaddr_un addr = {};
+  addr.sun_family  = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::runtime_error(std::format("socket path too long: {}", path));
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    throw std::runtime_error("failed to create socket");
+  }
+  unlink(path.c_str());
+  if (bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0) {
+    close(listen_fd);
+    throw std::runtime_error(std::format("failed to listen on: {}", path));
+  }
+
+  while (true) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS ||
+          errno == ENOMEM) {
+        // Out of resources until some connection closes.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+      int error = errno;
+      close(listen_fd);
+      throw std::runtime_error(
+          std::format("failed to accept on {}: {}", path, std::strerror(error))
+      );
+    }
+    std::thread([this, fd]() {
+      std::string buffer;
+      bool        closed = false;
+
+      auto read_line = [&](std::string &line) {
+        while (true) {
+          std::size_t newline = buffer.find('\n');
+          if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+          }
+          char    chunk[4096];
+          ssize_t n = closed ? 0 : read(fd, chunk, sizeof(chunk));
+          if (n <= 0) {
+            closed = true;
+            if (buffer.empty()) {
+              return false;
+            }
+            line = std::move(buffer);
+            buffer.clear();
+            return true;
+          }
+          buffer.append(chunk, n);
+        }
+      };
+
+      // Responses to a client which has gone away are discarded.
+      auto write = [&](const std::string &response) {
+        std::size_t sent = 0;
+        while (sent < response.size()) {
+          ssize_t n = send(
+              fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL
+          );
+          if (n <= 0) {
+            return;
+          }
+          sent += n;
+        }
+      };
+
+      serve(read_line, write);
+      close(fd);
+    }).detach();
+  }
+#endif
+}
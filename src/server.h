@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Serves solver requests, one per line, answering each with one line of JSON.
+// Requests are answered concurrently by a pool of workers, each reusing its
+// own solver from one request to the next, so clients may pipeline requests.
+// The pool lives as long as the server and answers the requests of every
+// client. Responses are written to each client in its request order, tagged
+// with the request's sequence number.
+//
+// Requests take one of the following forms, where a game is given in the
+// format `<SUIT> <SEAT> <HANDS>`, optionally followed by the cards already
+// played to the current trick:
+//
+//   [solve] <GAME>       the number of tricks taken by each side
+//   plays <GAME>         the number of tricks taken after each valid play
+//   bound <N> <GAME>     whether NS take at least N tricks
+//   table <HANDS>        the double dummy table
+class Server {
+public:
+  Server();
+  ~Server();
+
+  // Sets the number of workers. The workers are started by the first request,
+  // after which the number is fixed.
+  void enable_threads(int num_threads);
+  // Bounds the memory used by each worker's transposition table.
+  void enable_tpn_memory_budget(int64_t max_bytes);
+
+  // Serves requests read from a stream until the end of input.
+  void serve(std::istream &in, std::ostream &out);
+  // Listens on a Unix domain socket, serving each connection as a stream of
+  // requests. Never returns, unless the socket cannot be opened or accepting
+  // connections fails.
+  void serve_unix_socket(const std::string &path);
+
+private:
+  struct Worker;
+  struct Client;
+
+  struct Request {
+    Client     *client = nullptr;
+    int64_t     seq    = 0;
+    std::string line;
+  };
+
+  void serve(
+      std::function<bool(std::string &)>        read_line,
+      std::function<void(const std::string &)> write
+  );
+  void submit(Request request);
+  void work();
+  std::string answer(int64_t seq, const std::string &request, Worker &worker);
+
+  int     num_threads_;
+  int64_t tpn_memory_budget_;
+
+  // Requests waiting for a worker, from all clients.
+  std::mutex               mutex_;
+  std::condition_variable  queued_cv_;
+  std::condition_variable  space_cv_;
+  std::deque<Request>      queue_;
+  std::vector<std::thread> threads_;
+  bool                     stop_;
+};
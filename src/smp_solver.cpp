@@ -0,0 +1,80 @@
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "smp_solver.h"
+
+SmpSolver::SmpSolver(Game g, int num_threads)
+    : tpn_table_(std::make_shared<TpnTable>(
+          num_threads > 1 ? TpnTable::CONCURRENT_SHARDS : 1
+      )) {
+  num_threads = std::max(1, num_threads);
+  solvers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    Solver &solver = solvers_.emplace_back(g, tpn_table_);
+    if (i > 0) {
+      solver.enable_order_perturbation(i * 0x9e3779b97f4a7c15ull);
+    }
+  }
+}
+
+Solver::Stats SmpSolver::stats() const {
+  Solver::Stats stats = solvers_[0].stats();
+  for (std::size_t i = 1; i < solvers_.size(); i++) {
+    Solver::Stats solver_stats = solvers_[i].stats();
+    stats.nodes_explored += solver_stats.nodes_explored;
+    stats.tpn_table_stats.add_counters(solver_stats.tpn_table_stats);
+    stats.search_counters.add(solver_stats.search_counters);
+  }
+  return stats;
+}
+
+void SmpSolver::reset(Game g, Solver::ResetPolicy policy) {
+  // The first solver applies the policy to the shared table.
+  solvers_[0].reset(g, policy);
+  for (std::size_t i = 1; i < solvers_.size(); i++) {
+    solvers_[i].reset(g, Solver::KEEP_TPN_TABLE);
+  }
+}
+
+Solver::Result SmpSolver::solve() {
+  return solve(0, solvers_[0].game().tricks_max());
+}
+
+Solver::Result SmpSolver::solve(int alpha, int beta) {
+  std::atomic<bool>             done = false;
+  std::optional<Solver::Result> result;
+  std::mutex                    result_mutex;
+
+  auto search = [&](Solver &solver) {
+    auto r = solver.solve(alpha, beta);
+    // The flag is only ever set under the lock, so if it is still clear then
+    // this search ran to completion and its result is valid.
+    std::lock_guard<std::mutex> lock(result_mutex);
+    if (!done) {
+      result = r;
+      done   = true;
+    }
+  };
+
+  for (Solver &solver : solvers_) {
+    solver.enable_abort(&done);
+  }
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < solvers_.size(); i++) {
+    threads.emplace_back(search, std::ref(solvers_[i]));
+  }
+  search(solvers_[0]);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (Solver &solver : solvers_) {
+    solver.enable_abort(nullptr);
+  }
+
+  assert(result.has_value());
+  return *result;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "game_model.h"
+#include "solver.h"
+#include "tpn_table.h"
+
+// Solves a single game using several threads ("lazy SMP"). Each thread
+// searches the same root position, with all but the first thread using a
+// randomly perturbed play order. Threads share results through a common
+// transposition table, and the first thread to complete its search provides
+// the result.
+class SmpSolver {
+public:
+  SmpSolver(Game g, int num_threads);
+
+  Solver::Stats stats() const;
+  TpnTable     &tpn_table() { return *tpn_table_; }
+
+  // Rebinds all threads to a new game (see Solver::reset).
+  void reset(Game g, Solver::ResetPolicy policy = Solver::CLEAR_TPN_TABLE);
+
+  Solver::Result solve();
+  Solver::Result solve(int alpha, int beta);
+
+private:
+  std::shared_ptr<TpnTable> tpn_table_;
+  std::vector<Solver>       solvers_;
+};
@@ -1,25 +1,55 @@
 #include <format>
+#include <mutex>
 
 #include "fast_tricks.h"
+#include "mtdf.h"
 #include "play_order.h"
 #include "solver.h"
 
-Solver::Solver(Game g)
+Solver::Solver(Game g) : Solver(g, std::make_shared<TpnTable>()) {}
+
+Solver::Solver(Game g, std::shared_ptr<TpnTable> tpn_table)
     : game_(g),
       nodes_explored_(0),
-      tpn_table_(game_),
+      tpn_table_(std::move(tpn_table)),
+      play_history_enabled_(false),
       trace_os_(nullptr),
-      trace_lineno_(0) {
+      trace_lineno_(0),
+      perturb_state_(0),
+      abort_(nullptr),
+      pool_(nullptr),
+      split_min_tricks_(0),
+      split_point_(nullptr) {
   enable_all_optimizations(true);
 }
 
 Solver::~Solver() {}
 
 Solver::Stats Solver::stats() const {
-  return {
+  Stats stats = {
       .nodes_explored  = nodes_explored_,
-      .tpn_table_stats = tpn_table_.stats(),
+      .tpn_table_stats = tpn_table_->stats(),
+      .search_counters = {},
   };
+  stats.tpn_table_stats.add_counters(tpn_stats_);
+#ifdef DUMDUM_SEARCH_COUNTERS
+  stats.search_counters = search_counters_;
+#endif
+  return stats;
+}
+
+void Solver::reset(Game g, ResetPolicy policy) {
+  if (policy == CLEAR_TPN_TABLE || g.trump_suit() != game_.trump_suit()) {
+    tpn_table_->clear();
+  }
+  game_           = std::move(g);
+  nodes_explored_ = 0;
+  tpn_stats_      = {};
+  trace_lineno_   = 0;
+  play_history_.clear();
+#ifdef DUMDUM_SEARCH_COUNTERS
+  search_counters_ = {};
+#endif
 }
 
 void Solver::enable_all_optimizations(bool enabled) {
@@ -37,11 +67,64 @@ void Solver::enable_fast_tricks(bool enabled) {
   fast_tricks_enabled_ = enabled;
 }
 
+void Solver::enable_play_history(bool enabled) {
+  play_history_enabled_ = enabled;
+}
+
 void Solver::enable_tracing(std::ostream *os) {
   trace_os_     = os;
   trace_lineno_ = 0;
 }
 
+void Solver::enable_order_perturbation(uint64_t seed) { perturb_state_ = seed; }
+
+void Solver::enable_abort(const std::atomic<bool> *abort) { abort_ = abort; }
+
+void Solver::enable_parallel_search(ThreadPool *pool, int split_min_tricks) {
+  pool_             = pool;
+  split_min_tricks_ = split_min_tricks;
+}
+
+// State shared between the tasks searching the remaining plays at a node.
+struct Solver::SplitPoint {
+  const SplitPoint *parent;
+  std::atomic<bool> abort;
+  std::mutex        mutex;
+  bool              maximizing;
+  int               alpha;
+  int               beta;
+  int               best_score;
+  bool              cutoff;
+  Cards             winners_by_rank;
+  Card              best_play;
+  int64_t           nodes_explored;
+  TpnBucket::Stats  tpn_stats;
+#ifdef DUMDUM_SEARCH_COUNTERS
+  SearchCounters search_counters;
+#endif
+};
+
+bool Solver::aborted() const {
+  if (abort_ && abort_->load(std::memory_order_relaxed)) {
+    return true;
+  }
+  for (const SplitPoint *sp = split_point_; sp; sp = sp->parent) {
+    if (sp->abort.load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void add_tpn_stats(TpnBucket::Stats &total, const TpnBucket::Stats &s) {
+  total.lookup_hits += s.lookup_hits;
+  total.lookup_misses += s.lookup_misses;
+  total.lookup_reads += s.lookup_reads;
+  total.insert_hits += s.insert_hits;
+  total.insert_misses += s.insert_misses;
+  total.insert_reads += s.insert_reads;
+}
+
 Solver::Result Solver::solve() { return solve(0, game_.tricks_max()); }
 
 Solver::Result Solver::solve(int alpha, int beta) {
@@ -50,7 +133,7 @@ Solver::Result Solver::solve(int alpha, int beta) {
   int   tricks_taken_by_ew = game_.tricks_max() - tricks_taken_by_ns;
 #ifndef NDEBUG
   if (tpn_table_enabled_) {
-    tpn_table_.check_invariants();
+    tpn_table_->check_invariants();
   }
 #endif
   return {
@@ -60,23 +143,108 @@ Solver::Result Solver::solve(int alpha, int beta) {
   };
 }
 
+Solver::Result Solver::solve_all_plays(std::vector<PlayResult> &plays) {
+  Result best = solve();
+
+  plays.clear();
+  if (game_.finished()) {
+    return best;
+  }
+
+  // No play does better than the best play, so each play is solved with the
+  // best result as the first guess and as a bound, using zero-window searches.
+  // Plays as good as the best play then need only a single search.
+  bool maximizing = game_.next_seat() == NORTH || game_.next_seat() == SOUTH;
+  int  tricks_taken_by_ns[52];
+
+  PlayOrder order;
+  order_plays(game_, order);
+  for (Card c : order) {
+    game_.play(c);
+    int lower_bound = game_.tricks_taken_by_ns();
+    int upper_bound = game_.tricks_taken_by_ns() + game_.tricks_left();
+    if (maximizing) {
+      upper_bound = best.tricks_taken_by_ns;
+    } else {
+      lower_bound = best.tricks_taken_by_ns;
+    }
+    Result r = solve_mtdf(
+        *this, game_, best.tricks_taken_by_ns, lower_bound, upper_bound
+    );
+    tricks_taken_by_ns[c.index()] = r.tricks_taken_by_ns;
+    game_.unplay();
+  }
+
+  // Plays which were pruned as equivalent are lower in rank than the play
+  // which represents them, so are visited after it.
+  Cards solved = game_.valid_plays_pruned();
+  int   suit_tricks[4];
+  for (Card c : game_.valid_plays_all().high_to_low()) {
+    if (solved.contains(c)) {
+      suit_tricks[c.suit()] = tricks_taken_by_ns[c.index()];
+    }
+    int tricks = suit_tricks[c.suit()];
+    plays.push_back({
+        .card               = c,
+        .tricks_taken_by_ns = tricks,
+        .tricks_taken_by_ew = game_.tricks_max() - tricks,
+    });
+  }
+
+  return best;
+}
+
+std::vector<Solver::Result>
+Solver::solve_replay(const std::vector<Card> &plays) {
+  std::vector<Result> results;
+  results.reserve(plays.size() + 1);
+
+  // Each position is seeded with the result of the previous position, which
+  // is unchanged by any play which is not a mistake.
+  results.push_back(solve_mtdf(*this, game_, estimate_tricks(game_)));
+  for (Card c : plays) {
+    if (!game_.valid_play(c)) {
+      throw std::runtime_error(std::format("invalid play: {}", c));
+    }
+    game_.play(c);
+    int guess = results.back().tricks_taken_by_ns;
+    results.push_back(solve_mtdf(*this, game_, guess));
+  }
+
+  return results;
+}
+
 #define TRACE(tag, alpha, beta, score)                                         \
   if (trace_os_) {                                                             \
     trace(tag, alpha, beta, score);                                            \
   }
 
+#ifdef DUMDUM_SEARCH_COUNTERS
+#define COUNT(counter, n) search_counters_.depth(game_).counter += n
+#else
+#define COUNT(counter, n)
+#endif
+
 int Solver::solve_internal(int alpha, int beta, Cards &winners_by_rank) {
   if (game_.finished()) {
+    COUNT(terminals, 1);
     TRACE("terminal", alpha, beta, game_.tricks_taken_by_ns());
     return game_.tricks_taken_by_ns();
   }
 
   bool maximizing = game_.next_seat() == NORTH || game_.next_seat() == SOUTH;
 
+  // The best play stored with the position's table entry, if any.
+  std::optional<Card> best_play;
+
   if (game_.start_of_trick()) {
     if (tpn_table_enabled_) {
       int score;
-      if (tpn_table_.lookup(alpha, beta, score, winners_by_rank)) {
+      COUNT(tpn_lookups, 1);
+      if (tpn_table_->lookup(
+              game_, alpha, beta, score, winners_by_rank, tpn_stats_, &best_play
+          )) {
+        COUNT(tpn_hits, 1);
         TRACE("tpn_cutoff", alpha, beta, score);
         return score;
       }
@@ -85,21 +253,29 @@ int Solver::solve_internal(int alpha, int beta, Cards &winners_by_rank) {
     if (fast_tricks_enabled_) {
       int score;
       if (prune_fast_tricks(alpha, beta, score, winners_by_rank)) {
+        COUNT(ft_cutoffs, 1);
         TRACE("ft_cutoff", alpha, beta, score);
         return score;
       }
     }
 
     TRACE("start", alpha, beta, -1);
+  } else if (fast_tricks_enabled_) {
+    int score;
+    if (prune_current_trick(alpha, beta, score, winners_by_rank)) {
+      COUNT(ct_cutoffs, 1);
+      TRACE("ct_cutoff", alpha, beta, score);
+      return score;
+    }
   }
 
   int best_score = maximizing ? -1 : game_.tricks_max() + 1;
-  search_all_cards(alpha, beta, best_score, winners_by_rank);
+  search_all_cards(alpha, beta, best_score, winners_by_rank, best_play);
 
   if (game_.start_of_trick()) {
     TRACE("end", alpha, beta, best_score);
 
-    if (tpn_table_enabled_) {
+    if (tpn_table_enabled_ && !aborted()) {
       int lower_bound = game_.tricks_taken_by_ns();
       int upper_bound = game_.tricks_taken_by_ns() + game_.tricks_left();
       if (best_score < beta) {
@@ -108,7 +284,15 @@ int Solver::solve_internal(int alpha, int beta, Cards &winners_by_rank) {
       if (best_score > alpha) {
         lower_bound = best_score;
       }
-      tpn_table_.insert(winners_by_rank, lower_bound, upper_bound);
+      COUNT(tpn_inserts, 1);
+      tpn_table_->insert(
+          game_,
+          winners_by_rank,
+          lower_bound,
+          upper_bound,
+          tpn_stats_,
+          best_play
+      );
     }
   }
 
@@ -122,48 +306,101 @@ static void add_last_trick_wbr(const Game &game, Cards &winners_by_rank) {
   }
 }
 
+// Folds the score of a child node into the best score and search window.
+// Returns true if the child causes a cutoff.
+static bool update_best_score(
+    bool maximizing,
+    bool ab_pruning,
+    int  child_score,
+    int &alpha,
+    int &beta,
+    int &best_score
+) {
+  if (maximizing) {
+    if (child_score > best_score) {
+      best_score = child_score;
+    }
+    if (ab_pruning) {
+      alpha = std::max(alpha, best_score);
+      return best_score >= beta;
+    }
+  } else {
+    if (child_score < best_score) {
+      best_score = child_score;
+    }
+    if (ab_pruning) {
+      beta = std::min(beta, best_score);
+      return best_score <= alpha;
+    }
+  }
+  return false;
+}
+
+// Searches each play in turn, starting with the given best play (if any), and
+// sets the best play to the play with the best score.
 void Solver::search_all_cards(
-    int alpha, int beta, int &best_score, Cards &winners_by_rank
+    int                  alpha,
+    int                  beta,
+    int                 &best_score,
+    Cards               &winners_by_rank,
+    std::optional<Card> &best_play
 ) {
   nodes_explored_++;
 
   bool maximizing = game_.next_seat() == NORTH || game_.next_seat() == SOUTH;
 
   PlayOrder order;
-  order_plays(game_, order);
+  order_plays(
+      game_,
+      order,
+      play_history_enabled_ ? &play_history_ : nullptr,
+      best_play
+  );
+  COUNT(nodes, 1);
+  COUNT(plays, order.end() - order.begin());
+
+  if (perturb_state_) {
+    // xorshift64
+    perturb_state_ ^= perturb_state_ << 13;
+    perturb_state_ ^= perturb_state_ >> 7;
+    perturb_state_ ^= perturb_state_ << 17;
+    order.perturb(perturb_state_ & (perturb_state_ >> 32));
+  }
 
-  for (Card c : order) {
-    game_.play(c);
+  for (const Card *it = order.begin(); it != order.end(); it++) {
+    if (pool_ && it != order.begin() && order.end() - it >= 2 &&
+        game_.tricks_left() >= split_min_tricks_) {
+      search_split(
+          it, order.end(), alpha, beta, best_score, winners_by_rank, best_play
+      );
+      return;
+    }
+
+    game_.play(*it);
 
     Cards child_winners_by_rank;
     int   child_score = solve_internal(alpha, beta, child_winners_by_rank);
 
-    if (maximizing) {
-      if (child_score > best_score) {
-        best_score = child_score;
-      }
-      if (ab_pruning_enabled_) {
-        alpha = std::max(alpha, best_score);
-        if (best_score >= beta) {
-          winners_by_rank = child_winners_by_rank;
-          add_last_trick_wbr(game_, winners_by_rank);
-          game_.unplay();
-          return;
-        }
-      }
-    } else {
-      if (child_score < best_score) {
-        best_score = child_score;
-      }
-      if (ab_pruning_enabled_) {
-        beta = std::min(beta, best_score);
-        if (best_score <= alpha) {
-          winners_by_rank = child_winners_by_rank;
-          add_last_trick_wbr(game_, winners_by_rank);
-          game_.unplay();
-          return;
-        }
+    if (aborted()) {
+      game_.unplay();
+      return;
+    }
+
+    int  prev_score = best_score;
+    bool cutoff     = update_best_score(
+        maximizing, ab_pruning_enabled_, child_score, alpha, beta, best_score
+    );
+    if (best_score != prev_score) {
+      best_play = *it;
+    }
+    if (cutoff) {
+      winners_by_rank = child_winners_by_rank;
+      add_last_trick_wbr(game_, winners_by_rank);
+      game_.unplay();
+      if (play_history_enabled_) {
+        play_history_.add_cutoff(game_, *it);
       }
+      return;
     }
 
     winners_by_rank.add_all(child_winners_by_rank);
@@ -172,6 +409,107 @@ void Solver::search_all_cards(
   }
 }
 
+void Solver::search_split(
+    const Card          *begin,
+    const Card          *end,
+    int                  alpha,
+    int                  beta,
+    int                 &best_score,
+    Cards               &winners_by_rank,
+    std::optional<Card> &best_play
+) {
+  SplitPoint sp;
+  sp.parent          = split_point_;
+  sp.abort           = false;
+  sp.maximizing      = game_.next_seat() == NORTH || game_.next_seat() == SOUTH;
+  sp.alpha           = alpha;
+  sp.beta            = beta;
+  sp.best_score      = best_score;
+  sp.cutoff          = false;
+  sp.winners_by_rank = winners_by_rank;
+  sp.best_play       = best_play.value_or(*begin);
+  sp.nodes_explored  = 0;
+
+  ThreadPool::TaskGroup group;
+  for (const Card *it = begin; it != end; it++) {
+    Card c = *it;
+    pool_->run(group, [this, &sp, c]() { search_split_child(sp, c); });
+  }
+  pool_->wait(group);
+
+  nodes_explored_ += sp.nodes_explored;
+  add_tpn_stats(tpn_stats_, sp.tpn_stats);
+#ifdef DUMDUM_SEARCH_COUNTERS
+  search_counters_.add(sp.search_counters);
+#endif
+  best_score      = sp.best_score;
+  winners_by_rank = sp.winners_by_rank;
+  best_play       = sp.best_play;
+}
+
+void Solver::search_split_child(SplitPoint &sp, Card c) const {
+  if (sp.abort || aborted()) {
+    return;
+  }
+
+  // The parent solver is suspended until all tasks complete, so it is safe to
+  // copy its state here.
+  Solver child(*this);
+  child.nodes_explored_ = 0;
+  child.tpn_stats_      = {};
+  child.trace_os_       = nullptr;
+  child.split_point_    = &sp;
+#ifdef DUMDUM_SEARCH_COUNTERS
+  child.search_counters_ = {};
+#endif
+
+  int alpha, beta;
+  {
+    std::lock_guard<std::mutex> lock(sp.mutex);
+    alpha = sp.alpha;
+    beta  = sp.beta;
+  }
+
+  child.game_.play(c);
+  Cards child_winners_by_rank;
+  int   child_score =
+      child.solve_internal(alpha, beta, child_winners_by_rank);
+  add_last_trick_wbr(child.game_, child_winners_by_rank);
+
+  std::lock_guard<std::mutex> lock(sp.mutex);
+
+  sp.nodes_explored += child.nodes_explored_;
+  add_tpn_stats(sp.tpn_stats, child.tpn_stats_);
+#ifdef DUMDUM_SEARCH_COUNTERS
+  sp.search_counters.add(child.search_counters_);
+#endif
+
+  if (sp.cutoff || child.aborted()) {
+    return;
+  }
+
+  int  prev_score = sp.best_score;
+  bool cutoff     = update_best_score(
+      sp.maximizing,
+      ab_pruning_enabled_,
+      child_score,
+      sp.alpha,
+      sp.beta,
+      sp.best_score
+  );
+  if (sp.best_score != prev_score) {
+    sp.best_play = c;
+  }
+  if (cutoff) {
+    sp.cutoff          = true;
+    sp.winners_by_rank = child_winners_by_rank;
+    sp.abort           = true;
+    return;
+  }
+
+  sp.winners_by_rank.add_all(child_winners_by_rank);
+}
+
 bool Solver::prune_fast_tricks(
     int alpha, int beta, int &score, Cards &winners_by_rank
 ) const {
@@ -199,6 +537,64 @@ bool Solver::prune_fast_tricks(
     }
   }
 
+  // The sure tricks of the side not on lead bound the score from the other
+  // side.
+  int   sure_tricks;
+  Cards sure_wbr;
+  estimate_sure_tricks(
+      game_.hands(),
+      game_.next_seat(),
+      game_.trump_suit(),
+      sure_tricks,
+      sure_wbr
+  );
+
+  if (game_.next_seat() == NORTH || game_.next_seat() == SOUTH) {
+    int ub = game_.tricks_taken_by_ns() + game_.tricks_left() - sure_tricks;
+    if (ub <= alpha) {
+      score           = ub;
+      winners_by_rank = sure_wbr;
+      return true;
+    }
+  } else {
+    int lb = game_.tricks_taken_by_ns() + sure_tricks;
+    if (lb >= beta) {
+      score           = lb;
+      winners_by_rank = sure_wbr;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Solver::prune_current_trick(
+    int alpha, int beta, int &score, Cards &winners_by_rank
+) const {
+  const Trick &trick   = game_.current_trick();
+  Card         winning = trick.winning_card();
+  Seat         winner  = trick.winning_seat();
+  bool         ns_wins = winner == NORTH || winner == SOUTH;
+
+  // The trick is decided if no seat still to play on the other side can beat
+  // the winning card.
+  for (int i = trick.card_count(); i < 4; i++) {
+    Seat  seat  = trick.seat(i);
+    Cards plays = trick.valid_plays(game_.hands().hand(seat));
+    if ((seat == NORTH || seat == SOUTH) != ns_wins &&
+        !plays.intersect(trick.winning_cards()).empty()) {
+      return false;
+    }
+  }
+
+  // The cards winning the trick are the only ranks the bounds depend on.
+  int lb = game_.tricks_taken_by_ns() + (ns_wins ? 1 : 0);
+  int ub = game_.tricks_taken_by_ns() + game_.tricks_left() - (ns_wins ? 0 : 1);
+  if (lb >= beta || ub <= alpha) {
+    score           = lb >= beta ? lb : ub;
+    winners_by_rank = Cards::higher_ranking_or_eq(winning);
+    return true;
+  }
   return false;
 }
 
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "game_model.h"
+#include "play_order.h"
+#include "search_counters.h"
+#include "thread_pool.h"
 #include "tpn_table.h"
 
 #include <absl/container/flat_hash_map.h>
 #include <array>
+#include <atomic>
+#include <memory>
 #include <ostream>
 #include <vector>
 
@@ -16,46 +21,123 @@ public:
     Cards winners_by_rank;
   };
 
+  struct PlayResult {
+    Card card;
+    int  tricks_taken_by_ns;
+    int  tricks_taken_by_ew;
+  };
+
   struct Stats {
     int64_t         nodes_explored;
     TpnTable::Stats tpn_table_stats;
+    // All zero unless built with DUMDUM_SEARCH_COUNTERS.
+    SearchCounters  search_counters;
+  };
+
+  // Whether to keep the transposition table when rebinding to a new game.
+  enum ResetPolicy {
+    CLEAR_TPN_TABLE,
+    KEEP_TPN_TABLE,
   };
 
   Solver(Game g);
+  // Creates a solver which shares a transposition table with other solvers.
+  // All games solved using the same table must have the same trump suit.
+  Solver(Game g, std::shared_ptr<TpnTable> tpn_table);
   ~Solver();
 
   Stats stats() const;
 
+  // Rebinds the solver to a new game, resetting its statistics but keeping its
+  // allocations. Table entries are only kept if requested and the new game has
+  // the same trump suit. Clearing the table affects any solvers sharing it.
+  void reset(Game g, ResetPolicy policy = CLEAR_TPN_TABLE);
+
   void enable_all_optimizations(bool enabled);
   void enable_ab_pruning(bool enabled);
   void enable_tpn_table(bool enabled);
   void enable_play_order(bool enabled);
   void enable_fast_tricks(bool enabled);
+  // Orders discards using the history of cutoffs found by the search (see
+  // PlayHistory). Not included in all optimizations, as it does not reduce the
+  // nodes explored by `dumdum bench`.
+  void enable_play_history(bool enabled);
   void enable_tracing(std::ostream *os);
+  // Randomly perturbs play order using the given seed (zero disables).
+  void enable_order_perturbation(uint64_t seed);
+  // Abandons search once the given flag is set. The result of an abandoned
+  // search is meaningless, but the transposition table remains valid.
+  void enable_abort(const std::atomic<bool> *abort);
+  // Searches in parallel using the given thread pool ("young brothers wait").
+  // At nodes with at least the given number of tricks left, the first play is
+  // searched serially and the remaining plays are searched as parallel tasks.
+  // The transposition table must be safe for concurrent use.
+  void enable_parallel_search(ThreadPool *pool, int split_min_tricks);
 
   Game       &game() { return game_; }
   const Game &game() const { return game_; }
+  TpnTable   &tpn_table() { return *tpn_table_; }
 
   Result solve();
   Result solve(int alpha, int beta);
+  // Solves the position, and also the result of every valid play at the
+  // position. Plays which are equivalent (e.g., touching honors) are solved
+  // once, but reported individually.
+  Result solve_all_plays(std::vector<PlayResult> &plays);
+  // Solves the position, then advances the game by each of the given plays in
+  // turn, solving each position reached. Positions share the transposition
+  // table, so most of each position is solved by entries stored while solving
+  // earlier ones. Returns the result of every position solved.
+  std::vector<Result> solve_replay(const std::vector<Card> &plays);
 
 private:
+  struct SplitPoint;
+
   int  solve_internal(int alpha, int beta, Cards &winners_by_rank);
   bool prune_fast_tricks(
       int alpha, int beta, int &score, Cards &winners_by_rank
   ) const;
+  bool prune_current_trick(
+      int alpha, int beta, int &score, Cards &winners_by_rank
+  ) const;
   void search_all_cards(
-      int alpha, int beta, int &best_score, Cards &winners_by_rank
+      int                  alpha,
+      int                  beta,
+      int                 &best_score,
+      Cards               &winners_by_rank,
+      std::optional<Card> &best_play
+  );
+  void search_split(
+      const Card          *begin,
+      const Card          *end,
+      int                  alpha,
+      int                  beta,
+      int                 &best_score,
+      Cards               &winners_by_rank,
+      std::optional<Card> &best_play
   );
+  void search_split_child(SplitPoint &sp, Card c) const;
   void trace(const char *tag, int alpha, int beta, int tricks_taken_by_ns);
+  bool aborted() const;
 
-  Game          game_;
-  int64_t       nodes_explored_;
-  TpnTable      tpn_table_;
-  bool          ab_pruning_enabled_;
-  bool          tpn_table_enabled_;
-  bool          play_order_enabled_;
-  bool          fast_tricks_enabled_;
-  std::ostream *trace_os_;
-  int64_t       trace_lineno_;
+  Game                      game_;
+  int64_t                   nodes_explored_;
+  std::shared_ptr<TpnTable> tpn_table_;
+  TpnBucket::Stats          tpn_stats_;
+  PlayHistory               play_history_;
+  bool                      ab_pruning_enabled_;
+  bool                      tpn_table_enabled_;
+  bool                      play_order_enabled_;
+  bool                      fast_tricks_enabled_;
+  bool                      play_history_enabled_;
+  std::ostream             *trace_os_;
+  int64_t                   trace_lineno_;
+  uint64_t                  perturb_state_;
+  const std::atomic<bool>  *abort_;
+  ThreadPool               *pool_;
+  int                       split_min_tricks_;
+  const SplitPoint         *split_point_;
+#ifdef DUMDUM_SEARCH_COUNTERS
+  SearchCounters search_counters_;
+#endif
 };
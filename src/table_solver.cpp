@@ -0,0 +1,114 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "table_solver.h"
+
+TableSolver::Result::Result() {
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      tricks_[strain][seat] = -1;
+    }
+  }
+}
+
+int TableSolver::Result::tricks(Suit strain, Seat declarer) const {
+  return tricks_[strain][declarer];
+}
+
+void TableSolver::Result::set_tricks(Suit strain, Seat declarer, int tricks) {
+  tricks_[strain][declarer] = (int8_t)tricks;
+}
+
+TableSolver::TableSolver(const Hands &hands)
+    : hands_(hands),
+      num_threads_(1),
+      tpn_memory_budget_(0),
+      stats_{} {}
+
+Solver::Stats TableSolver::stats() const { return stats_; }
+
+void TableSolver::enable_threads(int num_threads) {
+  num_threads_ = std::max(1, num_threads);
+}
+
+void TableSolver::enable_tpn_memory_budget(int64_t max_bytes) {
+  tpn_memory_budget_ = max_bytes;
+}
+
+static void add_stats(Solver::Stats &total, const Solver::Stats &stats) {
+  total.nodes_explored += stats.nodes_explored;
+  total.tpn_table_stats.buckets += stats.tpn_table_stats.buckets;
+  total.tpn_table_stats.entries += stats.tpn_table_stats.entries;
+  total.tpn_table_stats.bytes += stats.tpn_table_stats.bytes;
+  total.tpn_table_stats.evicted_buckets +=
+      stats.tpn_table_stats.evicted_buckets;
+  total.tpn_table_stats.add_counters(stats.tpn_table_stats);
+  total.search_counters.add(stats.search_counters);
+}
+
+TableSolver::Result TableSolver::solve() {
+  Result           result;
+  std::atomic<int> next_strain = FIRST_SUIT;
+  std::mutex       stats_mutex;
+
+  stats_ = {};
+
+  auto worker = [&]() {
+    while (true) {
+      int strain = next_strain++;
+      if (strain > NO_TRUMP) {
+        return;
+      }
+      Solver::Stats strain_stats = {};
+      solve_strain((Suit)strain, result, strain_stats);
+      std::lock_guard<std::mutex> lock(stats_mutex);
+      add_stats(stats_, strain_stats);
+    }
+  };
+
+  int num_workers = std::min(num_threads_, NO_TRUMP + 1);
+  if (num_workers == 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_workers; i++) {
+      threads.emplace_back(worker);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  return result;
+}
+
+void TableSolver::solve_strain(
+    Suit strain, Result &result, Solver::Stats &stats
+) const {
+  // The transposition table is keyed on the seat next to play and the
+  // (normalized) hands, so its contents remain valid across opening leaders.
+  auto tpn_table = std::make_shared<TpnTable>();
+  tpn_table->enable_memory_budget(tpn_memory_budget_);
+
+  for (Seat lead_seat = FIRST_SEAT; lead_seat <= LAST_SEAT; lead_seat++) {
+    Solver solver(Game(strain, lead_seat, hands_), tpn_table);
+    auto   r        = solver.solve();
+    Seat   declarer = left_seat(lead_seat);
+    bool   ns       = declarer == NORTH || declarer == SOUTH;
+    result.set_tricks(
+        strain, declarer, ns ? r.tricks_taken_by_ns : r.tricks_taken_by_ew
+    );
+    auto solver_stats = solver.stats();
+    stats.nodes_explored += solver_stats.nodes_explored;
+    stats.tpn_table_stats.add_counters(solver_stats.tpn_table_stats);
+    stats.search_counters.add(solver_stats.search_counters);
+  }
+
+  auto tpn_table_stats                  = tpn_table->stats();
+  stats.tpn_table_stats.buckets         = tpn_table_stats.buckets;
+  stats.tpn_table_stats.entries         = tpn_table_stats.entries;
+  stats.tpn_table_stats.bytes           = tpn_table_stats.bytes;
+  stats.tpn_table_stats.evicted_buckets = tpn_table_stats.evicted_buckets;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "game_model.h"
+#include "solver.h"
+
+// Solves the full double dummy table for a deal, i.e., the number of tricks
+// taken by each declarer in each strain. Strains are solved independently (and
+// optionally in parallel), while the four opening leads within a strain share
+// a single transposition table.
+class TableSolver {
+public:
+  class Result {
+  public:
+    Result();
+
+    int  tricks(Suit strain, Seat declarer) const;
+    void set_tricks(Suit strain, Seat declarer, int tricks);
+
+  private:
+    int8_t tricks_[5][4];
+  };
+
+  TableSolver(const Hands &hands);
+
+  Solver::Stats stats() const;
+
+  void enable_threads(int num_threads);
+  // Bounds the memory used by the transposition table for each strain.
+  void enable_tpn_memory_budget(int64_t max_bytes);
+
+  Result solve();
+
+private:
+  void solve_strain(Suit strain, Result &result, Solver::Stats &stats) const;
+
+  Hands         hands_;
+  int           num_threads_;
+  int64_t       tpn_memory_budget_;
+  Solver::Stats stats_;
+};
+
+// ----------------------
+// Implementation Details
+// ----------------------
+
+template <> struct std::formatter<TableSolver::Result> {
+  constexpr auto parse(auto &ctx) { return ctx.begin(); }
+
+  auto format(const TableSolver::Result &result, auto &ctx) const {
+    auto out = ctx.out();
+    for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+      if (strain != FIRST_SUIT) {
+        out = std::format_to(out, "{}", '.');
+      }
+      for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+        out = std::format_to(out, "{:x}", result.tricks(strain, seat));
+      }
+    }
+    return out;
+  }
+};
@@ -0,0 +1,117 @@
+#include <optional>
+
+#include "thread_pool.h"
+
+static thread_local const ThreadPool *tls_pool        = nullptr;
+static thread_local int               tls_queue_index = 0;
+
+ThreadPool::ThreadPool(int num_threads) : queued_(0), stop_(false) {
+  num_threads = std::max(0, num_threads);
+  for (int i = 0; i <= num_threads; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads_.emplace_back(&ThreadPool::worker, this, i + 1);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+int ThreadPool::queue_index() const {
+  return tls_pool == this ? tls_queue_index : 0;
+}
+
+void ThreadPool::run(TaskGroup &group, Task task) {
+  group.pending_++;
+  {
+    Queue                      &queue = *queues_[queue_index()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.items.push_back({.group = &group, .task = std::move(task)});
+  }
+  {
+    // Increment under the sleep lock so that sleeping workers cannot miss the
+    // notification.
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_++;
+  }
+  sleep_cv_.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup &group) {
+  int index = queue_index();
+  while (group.pending_ > 0) {
+    if (try_run_one(index)) {
+      continue;
+    }
+    // Nothing to steal, so sleep until the group's last task completes or
+    // more work is queued.
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_cv_.wait(lock, [&]() { return group.pending_ == 0 || queued_ > 0; });
+  }
+}
+
+bool ThreadPool::try_run_one(int index) {
+  std::optional<Item> item;
+
+  {
+    Queue                      &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.items.empty()) {
+      item.emplace(std::move(queue.items.back()));
+      queue.items.pop_back();
+    }
+  }
+
+  int num_queues = (int)queues_.size();
+  for (int i = 1; i < num_queues && !item.has_value(); i++) {
+    Queue                      &queue = *queues_[(index + i) % num_queues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.items.empty()) {
+      item.emplace(std::move(queue.items.front()));
+      queue.items.pop_front();
+    }
+  }
+
+  if (!item.has_value()) {
+    return false;
+  }
+
+  queued_--;
+  item->task();
+  // The group may be destroyed once its last task completes, as soon as its
+  // waiting thread sees the count reach zero.
+  if (--item->group->pending_ == 0) {
+    {
+      // Lock so that a thread about to wait on the group cannot miss the
+      // notification.
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_all();
+  }
+  return true;
+}
+
+void ThreadPool::worker(int index) {
+  tls_pool        = this;
+  tls_queue_index = index;
+
+  while (true) {
+    if (try_run_one(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A work-stealing thread pool. Each worker thread has its own task queue, and
+// takes new work from the back of its own queue (most recently submitted
+// first) before stealing from the front of other threads' queues.
+//
+// Tasks are submitted as part of a task group. Threads waiting on a group run
+// pending tasks until all tasks in the group have completed, so tasks may
+// themselves submit and wait on nested groups without deadlocking the pool.
+// When there is nothing left to run, waiting threads sleep until the group
+// completes or more tasks are submitted.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  class TaskGroup {
+  public:
+    TaskGroup() : pending_(0) {}
+
+  private:
+    friend class ThreadPool;
+
+    std::atomic<int> pending_;
+  };
+
+  // Creates a pool with the given number of worker threads (which may be
+  // zero, in which case tasks run on threads which wait on them).
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  int num_threads() const { return (int)threads_.size(); }
+
+  void run(TaskGroup &group, Task task);
+  void wait(TaskGroup &group);
+
+private:
+  struct Item {
+    TaskGroup *group;
+    Task       task;
+  };
+
+  struct Queue {
+    std::mutex       mutex;
+    std::deque<Item> items;
+  };
+
+  int  queue_index() const;
+  bool try_run_one(int queue_index);
+  void worker(int queue_index);
+
+  // Queue 0 receives tasks from threads outside the pool, while queue i + 1
+  // belongs to worker thread i.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread>            threads_;
+  std::atomic<int>                    queued_;
+  std::mutex                          sleep_mutex_;
+  std::condition_variable             sleep_cv_;
+  bool                                stop_;
+};
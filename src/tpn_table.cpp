@@ -1,161 +1,456 @@
+#include <algorithm>
+#include <bit>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "tpn_table.h"
 
-static bool generalizes(const Hands &partition1, const Hands &partition2) {
+[[maybe_unused]] static bool
+generalizes(const Hands &partition1, const Hands &partition2) {
   return partition2.contains_all(partition1);
 }
 
+TpnBucket::TpnBucket(Arena &arena, int tricks_left)
+    : arena_(&arena),
+      first_(NONE),
+      entries_count_(0),
+      hits_(0),
+      tricks_left_((int8_t)tricks_left) {}
+
 bool TpnBucket::lookup(
-    const Hands &hands, int alpha, int beta, int &score, Cards &winners_by_rank
+    const Hands &hands,
+    int          alpha,
+    int          beta,
+    int         &score,
+    Cards       &winners_by_rank,
+    Stats       &stats,
+    int         *best_play
 ) const {
-  bool success = lookup(entries_, hands, alpha, beta, score, winners_by_rank);
+  int  play    = NO_PLAY;
+  bool success = lookup(
+      first_, hands, alpha, beta, score, winners_by_rank, stats, play
+  );
+  if (best_play) {
+    *best_play = play;
+  }
   if (success) {
-    stats_.lookup_hits++;
+    hits_++;
+    stats.lookup_hits++;
   } else {
-    stats_.lookup_misses++;
+    stats.lookup_misses++;
   }
   return success;
 }
 
 void TpnBucket::insert(
-    const Hands &partition, int lower_bound, int upper_bound
+    const Hands &partition,
+    int          lower_bound,
+    int          upper_bound,
+    Stats       &stats,
+    int          best_play
 ) {
   assert(lower_bound <= upper_bound);
   assert(lower_bound >= MIN_BOUND && upper_bound <= MAX_BOUND);
   Bounds bounds = {
       .lower_bound = (int8_t)lower_bound, .upper_bound = (int8_t)upper_bound
   };
-  insert(entries_, partition, bounds);
+  insert(first_, partition, bounds, stats, best_play);
+}
+
+void TpnBucket::clear() {
+  free_all(first_);
+  first_         = NONE;
+  entries_count_ = 0;
+}
+
+// Returns a mask of the entries in the block whose partitions are contained in
+// the given hands, i.e., which have no cards outside of the hands.
+static uint32_t
+contained_in(const uint64_t (&partitions)[4][4], const Hands &hands) {
+#ifdef __AVX2__
+  __m256i outside = _mm256_setzero_si256();
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    __m256i p = _mm256_load_si256((const __m256i *)partitions[seat]);
+    __m256i h = _mm256_set1_epi64x((int64_t)hands.hand(seat).bits());
+    outside   = _mm256_or_si256(outside, _mm256_andnot_si256(h, p));
+  }
+  __m256i empty = _mm256_cmpeq_epi64(outside, _mm256_setzero_si256());
+  return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(empty));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < 4; i++) {
+    uint64_t outside = 0;
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      outside |= partitions[seat][i] & ~hands.hand(seat).bits();
+    }
+    mask |= (uint32_t)(outside == 0) << i;
+  }
+  return mask;
+#endif
+}
+
+// Returns a mask of the entries in the block whose partitions contain the
+// given partition.
+static uint32_t
+containing(const uint64_t (&partitions)[4][4], const Hands &partition) {
+#ifdef __AVX2__
+  __m256i outside = _mm256_setzero_si256();
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    __m256i p = _mm256_load_si256((const __m256i *)partitions[seat]);
+    __m256i h = _mm256_set1_epi64x((int64_t)partition.hand(seat).bits());
+    outside   = _mm256_or_si256(outside, _mm256_andnot_si256(p, h));
+  }
+  __m256i empty = _mm256_cmpeq_epi64(outside, _mm256_setzero_si256());
+  return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(empty));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < 4; i++) {
+    uint64_t outside = 0;
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      outside |= partition.hand(seat).bits() & ~partitions[seat][i];
+    }
+    mask |= (uint32_t)(outside == 0) << i;
+  }
+  return mask;
+#endif
 }
 
 bool TpnBucket::lookup(
-    const std::vector<Entry> &entries,
-    const Hands              &hands,
-    int                       alpha,
-    int                       beta,
-    int                      &score,
-    Cards                    &winners_by_rank
+    uint32_t     first,
+    const Hands &hands,
+    int          alpha,
+    int          beta,
+    int         &score,
+    Cards       &winners_by_rank,
+    Stats       &stats,
+    int         &best_play
 ) const {
-  for (auto &entry : entries) {
-    stats_.lookup_reads++;
-    if (hands.contains_all(entry.partition)) {
-      if (entry.bounds.lower_bound == entry.bounds.upper_bound ||
-          entry.bounds.lower_bound >= beta) {
-        score           = entry.bounds.lower_bound;
-        winners_by_rank = entry.partition.all_cards();
+  const Arena &arena = *arena_;
+  for (uint32_t b = first; b != NONE; b = arena[b].next) {
+    const Block &block = arena[b];
+    stats.lookup_reads += block.size;
+    // The partitions of children contain the partitions of their parents, so
+    // only the children of entries contained in the hands can match.
+    uint32_t contained = contained_in(block.partitions, hands) &
+                         ((1u << block.size) - 1);
+    for (; contained; contained &= contained - 1) {
+      int    i      = std::countr_zero(contained);
+      Bounds bounds = block.bounds[i];
+      if (bounds.lower_bound == bounds.upper_bound ||
+          bounds.lower_bound >= beta) {
+        score           = bounds.lower_bound;
+        winners_by_rank = block.partition(i).all_cards();
         return true;
       }
-      if (entry.bounds.upper_bound <= alpha) {
-        score           = entry.bounds.upper_bound;
-        winners_by_rank = entry.partition.all_cards();
+      if (bounds.upper_bound <= alpha) {
+        score           = bounds.upper_bound;
+        winners_by_rank = block.partition(i).all_cards();
         return true;
       }
-    }
-    if (lookup(entry.children, hands, alpha, beta, score, winners_by_rank)) {
-      return true;
+      if (block.first_child[i] != NONE &&
+          lookup(
+              block.first_child[i],
+              hands,
+              alpha,
+              beta,
+              score,
+              winners_by_rank,
+              stats,
+              best_play
+          )) {
+        return true;
+      }
+      // Children are more specific than their parents, so their best plays
+      // take precedence.
+      if (best_play == NO_PLAY) {
+        best_play = block.best_play(i);
+      }
     }
   }
   return false;
 }
 
-void TpnBucket::transfer_generalized(std::vector<Entry> &src, Entry &dest)
-    const {
-  for (std::size_t i = 0; i < src.size(); i++) {
-    auto &e = src[i];
-    if (generalizes(dest.partition, e.partition)) {
-      dest.children.emplace_back(std::move(e));
-      remove_at(src, i);
-      i--;
-    }
-  }
-}
-
 void TpnBucket::insert(
-    std::vector<Entry> &entries, const Hands &partition, Bounds bounds
+    uint32_t    &first,
+    const Hands &partition,
+    Bounds       bounds,
+    Stats       &stats,
+    int          best_play
 ) {
-  for (auto &entry : entries) {
-    stats_.insert_reads++;
-    if (partition == entry.partition) {
-      if (!entry.bounds.tighter_or_eq(bounds)) {
-        entry.bounds.tighten(bounds);
-        tighten_child_bounds(entry);
-      }
-      stats_.insert_hits++;
-      return;
-    } else if (generalizes(entry.partition, partition)) {
-      if (entry.bounds.tighter_or_eq(bounds)) {
-        stats_.insert_hits++;
+  Arena &arena = *arena_;
+  for (uint32_t b = first; b != NONE; b = arena[b].next) {
+    Block   &block       = arena[b];
+    uint32_t generalized = contained_in(block.partitions, partition);
+    uint32_t specialized = containing(block.partitions, partition);
+    for (int i = 0; i < block.size; i++) {
+      stats.insert_reads++;
+      bool more_general = generalized & (1 << i);
+      bool more_special = specialized & (1 << i);
+      if (more_general && more_special) {
+        if (!block.bounds[i].tighter_or_eq(bounds)) {
+          block.bounds[i].tighten(bounds);
+          tighten_child_bounds(block.bounds[i], block.first_child[i], stats);
+        }
+        if (best_play != NO_PLAY) {
+          block.set_best_play(i, best_play);
+        }
+        stats.insert_hits++;
         return;
-      } else {
-        bounds.tighten(entry.bounds);
-        insert(entry.children, partition, bounds);
+      } else if (more_general) {
+        if (block.bounds[i].tighter_or_eq(bounds)) {
+          stats.insert_hits++;
+          return;
+        } else {
+          bounds.tighten(block.bounds[i]);
+          insert(block.first_child[i], partition, bounds, stats, best_play);
+          return;
+        }
+      } else if (more_special) {
+        uint32_t children = remove_generalized(first, partition);
+        tighten_child_bounds(bounds, children, stats);
+        append(first, partition, bounds, children, best_play);
+        stats.insert_misses++;
         return;
       }
-    } else if (generalizes(partition, entry.partition)) {
-      Entry new_entry = {
-          .partition = partition, .bounds = bounds, .children = {}
-      };
-      transfer_generalized(entries, new_entry);
-      tighten_child_bounds(new_entry);
-      entries.emplace_back(std::move(new_entry));
-      stats_.insert_misses++;
-      stats_.entries++;
-      return;
     }
   }
 
-  Entry &entry    = entries.emplace_back();
-  entry.partition = partition;
-  entry.bounds    = bounds;
-  assert(entry.children.size() == 0);
-  stats_.insert_misses++;
-  stats_.entries++;
+  append(first, partition, bounds, NONE, best_play);
+  stats.insert_misses++;
 }
 
-void TpnBucket::check_invariants() const {
-  for (const Entry &entry : entries_) {
-    check_invariants(entry);
+void TpnBucket::append(
+    uint32_t    &first,
+    const Hands &partition,
+    Bounds       bounds,
+    uint32_t     children,
+    int          best_play
+) {
+  Arena    &arena = *arena_;
+  uint32_t  last  = NONE;
+  uint32_t *link  = &first;
+  while (*link != NONE) {
+    last = *link;
+    link = &arena[last].next;
   }
+  if (last == NONE || arena[last].size == Block::SIZE) {
+    last             = arena.allocate();
+    arena[last]      = Block{};
+    arena[last].next = NONE;
+    *link            = last;
+  }
+  Block &block = arena[last];
+  block.set(block.size++, partition, bounds, children, best_play);
+  entries_count_++;
+}
+
+void TpnBucket::append_list(uint32_t &first, uint32_t list) {
+  uint32_t *link = &first;
+  while (*link != NONE) {
+    link = &(*arena_)[*link].next;
+  }
+  *link = list;
 }
 
-void TpnBucket::check_invariants(const Entry &entry) const {
-  assert(entry.bounds.lower_bound <= entry.bounds.upper_bound);
-  for (const Entry &child : entry.children) {
-    assert(generalizes(entry.partition, child.partition));
-    assert(entry.partition != child.partition);
-    assert(child.bounds.tighter_or_eq(entry.bounds));
-    assert(entry.bounds != child.bounds);
-    check_invariants(child);
+// Removes the entries in the list which are generalized by the given
+// partition, returning them as a new list.
+uint32_t
+TpnBucket::remove_generalized(uint32_t &first, const Hands &partition) {
+  Arena    &arena   = *arena_;
+  uint32_t  removed = NONE;
+  uint32_t *link    = &first;
+  while (*link != NONE) {
+    uint32_t b     = *link;
+    Block   &block = arena[b];
+    uint32_t mask  = containing(block.partitions, partition);
+    // Remove from the end of the block, so that the entries moved into the
+    // place of removed entries have already been tested.
+    for (int i = block.size - 1; i >= 0; i--) {
+      if (mask & (1 << i)) {
+        Hands partition = block.partition(i);
+        append(
+            removed,
+            partition,
+            block.bounds[i],
+            block.first_child[i],
+            block.best_play(i)
+        );
+        block.remove_at(i);
+        entries_count_--;
+      }
+    }
+    if (block.size == 0) {
+      *link = block.next;
+      arena.free(b);
+    } else {
+      link = &block.next;
+    }
   }
+  return removed;
 }
 
-void TpnBucket::tighten_child_bounds(Entry &entry) {
-  for (std::size_t i = 0; i < entry.children.size(); i++) {
-    stats_.insert_reads++;
-    auto &child = entry.children[i];
-    if (!child.bounds.tighter(entry.bounds)) {
-      child.bounds.tighten(entry.bounds);
-      tighten_child_bounds(child);
-      if (child.bounds == entry.bounds) {
-        for (auto &grandchild : child.children) {
-          entry.children.emplace_back(std::move(grandchild));
+void TpnBucket::tighten_child_bounds(
+    Bounds bounds, uint32_t &first, Stats &stats
+) {
+  Arena    &arena = *arena_;
+  uint32_t *link  = &first;
+  while (*link != NONE) {
+    uint32_t b     = *link;
+    Block   &block = arena[b];
+    for (int i = 0; i < block.size;) {
+      stats.insert_reads++;
+      Bounds &child_bounds = block.bounds[i];
+      if (!child_bounds.tighter(bounds)) {
+        child_bounds.tighten(bounds);
+        tighten_child_bounds(child_bounds, block.first_child[i], stats);
+        if (child_bounds == bounds) {
+          // The child is now redundant, so replace it by its own children.
+          append_list(first, block.first_child[i]);
+          block.remove_at(i);
+          entries_count_--;
+          continue;
         }
-        remove_at(entry.children, i);
-        i--;
-        stats_.entries--;
       }
+      i++;
+    }
+    if (block.size == 0) {
+      *link = block.next;
+      arena.free(b);
+    } else {
+      link = &block.next;
     }
   }
 }
 
-void TpnBucket::remove_at(std::vector<Entry> &entries, std::size_t i) {
-  assert(i < entries.size());
-  if (i == entries.size() - 1) {
-    entries[i] = Entry();
-    entries.pop_back();
-  } else {
-    entries[i] = std::move(entries[entries.size() - 1]);
-    entries.pop_back();
+void TpnBucket::free_all(uint32_t first) {
+  Arena &arena = *arena_;
+  while (first != NONE) {
+    Block   &block = arena[first];
+    uint32_t next  = block.next;
+    for (int i = 0; i < block.size; i++) {
+      free_all(block.first_child[i]);
+    }
+    arena.free(first);
+    first = next;
+  }
+}
+
+void TpnBucket::check_invariants() const {
+  const Arena &arena = *arena_;
+  for (uint32_t b = first_; b != NONE; b = arena[b].next) {
+    const Block &block = arena[b];
+    assert(block.size > 0);
+    for (int i = 0; i < block.size; i++) {
+      assert(block.bounds[i].lower_bound <= block.bounds[i].upper_bound);
+      check_children(block, i);
+    }
+  }
+}
+
+void TpnBucket::check_children(const Block &block, int i) const {
+  const Arena &arena = *arena_;
+  for (uint32_t b = block.first_child[i]; b != NONE; b = arena[b].next) {
+    const Block &child = arena[b];
+    assert(child.size > 0);
+    for (int j = 0; j < child.size; j++) {
+      assert(generalizes(block.partition(i), child.partition(j)));
+      assert(block.partition(i) != child.partition(j));
+      assert(child.bounds[j].tighter_or_eq(block.bounds[i]));
+      assert(block.bounds[i] != child.bounds[j]);
+      check_children(child, j);
+    }
+  }
+}
+
+Hands TpnBucket::Block::partition(int i) const {
+  return Hands(
+      partitions[WEST][i],
+      partitions[NORTH][i],
+      partitions[EAST][i],
+      partitions[SOUTH][i]
+  );
+}
+
+// Plays are stored as six bits per entry, where all bits set means NO_PLAY.
+static constexpr uint32_t PACKED_NO_PLAY = 0b111111;
+
+int TpnBucket::Block::best_play(int i) const {
+  uint32_t packed = best_plays[0] | best_plays[1] << 8 | best_plays[2] << 16;
+  uint32_t play   = (packed >> (i * 6)) & PACKED_NO_PLAY;
+  return play == PACKED_NO_PLAY ? NO_PLAY : (int)play;
+}
+
+void TpnBucket::Block::set_best_play(int i, int best_play) {
+  static_assert(sizeof(Block) == 160);
+  uint32_t play   = best_play == NO_PLAY ? PACKED_NO_PLAY : (uint32_t)best_play;
+  uint32_t packed = best_plays[0] | best_plays[1] << 8 | best_plays[2] << 16;
+  packed          = (packed & ~(PACKED_NO_PLAY << (i * 6))) | play << (i * 6);
+  best_plays[0]   = (uint8_t)packed;
+  best_plays[1]   = (uint8_t)(packed >> 8);
+  best_plays[2]   = (uint8_t)(packed >> 16);
+}
+
+void TpnBucket::Block::set(
+    int          i,
+    const Hands &partition,
+    Bounds       bounds,
+    uint32_t     children,
+    int          best_play
+) {
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    partitions[seat][i] = partition.hand(seat).bits();
   }
+  this->bounds[i] = bounds;
+  first_child[i]  = children;
+  set_best_play(i, best_play);
+}
+
+void TpnBucket::Block::copy(int i, const Block &src, int src_i) {
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    partitions[seat][i] = src.partitions[seat][src_i];
+  }
+  bounds[i]      = src.bounds[src_i];
+  first_child[i] = src.first_child[src_i];
+  set_best_play(i, src.best_play(src_i));
+}
+
+void TpnBucket::Block::remove_at(int i) {
+  assert(i < size);
+  size--;
+  if (i != size) {
+    copy(i, *this, size);
+  }
+}
+
+uint32_t TpnBucket::Arena::allocate() {
+  size_++;
+  if (free_list_ != NONE) {
+    uint32_t i = free_list_;
+    free_list_ = (*this)[i].next;
+    return i;
+  }
+  if ((next_ >> CHUNK_BITS) == chunks_.size()) {
+    chunks_.emplace_back(std::make_unique<Block[]>(CHUNK_SIZE));
+  }
+  return next_++;
+}
+
+void TpnBucket::Arena::free(uint32_t i) {
+  size_--;
+  (*this)[i].next = free_list_;
+  free_list_      = i;
+}
+
+void TpnBucket::Arena::clear() {
+  free_list_ = NONE;
+  next_      = 0;
+  size_      = 0;
+}
+
+int64_t TpnBucket::Arena::bytes() const {
+  return (int64_t)chunks_.size() * chunk_bytes();
 }
 
 std::ostream &operator<<(std::ostream &os, const TpnBucketKey &key) {
@@ -172,62 +467,201 @@ std::ostream &operator<<(std::ostream &os, const TpnBucketKey &key) {
   return os;
 }
 
-bool TpnTable::lookup(int alpha, int beta, int &score, Cards &winners_by_rank)
-    const {
-  TpnBucketKey key(game_.next_seat(), game_.normalized_hands());
-  auto         it = table_.find(key);
-  if (it != table_.end()) {
-    alpha -= game_.tricks_taken_by_ns();
-    beta -= game_.tricks_taken_by_ns();
+TpnTable::Shard &TpnTable::shard(const TpnBucketKey &key) const {
+  if (!concurrent()) {
+    return shards_[0];
+  }
+  // Use the high bits of the hash, as the low bits are used within each
+  // shard's hash table.
+  uint64_t hash = absl::Hash<TpnBucketKey>{}(key);
+  return shards_[(hash >> 32) % num_shards_];
+}
+
+bool TpnTable::lookup(
+    const Game          &game,
+    int                  alpha,
+    int                  beta,
+    int                 &score,
+    Cards               &winners_by_rank,
+    TpnBucket::Stats    &stats,
+    std::optional<Card> *best_play
+) const {
+  const Hands &hands = game.normalized_hands();
+  TpnBucketKey key(game);
+  Shard       &shard = this->shard(key);
+
+  std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+  if (concurrent()) {
+    lock.lock();
+  }
+
+  if (best_play) {
+    best_play->reset();
+  }
+  auto it = shard.table.find(key);
+  if (it != shard.table.end()) {
+    alpha -= game.tricks_taken_by_ns();
+    beta -= game.tricks_taken_by_ns();
+    int play;
     if (it->second.lookup(
-            game_.normalized_hands(), alpha, beta, score, winners_by_rank
+            hands, alpha, beta, score, winners_by_rank, stats, &play
         )) {
-      score += game_.tricks_taken_by_ns();
-      winners_by_rank = game_.denormalize_wbr(winners_by_rank);
+      score += game.tricks_taken_by_ns();
+      winners_by_rank = game.denormalize_wbr(winners_by_rank);
       return true;
     }
+    if (best_play && play != TpnBucket::NO_PLAY) {
+      *best_play = game.denormalize_card(Card(play));
+    }
   }
   return false;
 }
 
-void TpnTable::insert(Cards winners_by_rank, int lower_bound, int upper_bound) {
-  lower_bound -= game_.tricks_taken_by_ns();
-  upper_bound -= game_.tricks_taken_by_ns();
-  const Hands &hands = game_.normalized_hands();
-  winners_by_rank    = game_.normalize_wbr(winners_by_rank);
+void TpnTable::insert(
+    const Game         &game,
+    Cards               winners_by_rank,
+    int                 lower_bound,
+    int                 upper_bound,
+    TpnBucket::Stats   &stats,
+    std::optional<Card> best_play
+) {
+  lower_bound -= game.tricks_taken_by_ns();
+  upper_bound -= game.tricks_taken_by_ns();
+  const Hands &hands = game.normalized_hands();
+  winners_by_rank    = game.normalize_wbr(winners_by_rank);
   Hands partition    = hands.make_partition(winners_by_rank);
 
-  TpnBucketKey key(game_.next_seat(), hands);
-  table_[key].insert(partition, lower_bound, upper_bound);
+  TpnBucketKey key(game);
+  Shard       &shard = this->shard(key);
+
+  std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+  if (concurrent()) {
+    lock.lock();
+  }
+
+  TpnBucket &bucket =
+      shard.table.try_emplace(key, shard.arena, game.tricks_left())
+          .first->second;
+  int play = best_play ? game.normalize_card(*best_play).index()
+                       : TpnBucket::NO_PLAY;
+  bucket.insert(partition, lower_bound, upper_bound, stats, play);
+
+  // Leave room for the arena to allocate another chunk within the budget.
+  int64_t max_used_bytes = max_shard_bytes_ - TpnBucket::Arena::chunk_bytes();
+  if (max_shard_bytes_ > 0 && shard.used_bytes() > max_used_bytes) {
+    evict(shard);
+  }
+}
+
+void TpnTable::evict(Shard &shard) {
+  std::vector<std::pair<int64_t, TpnBucketKey>> buckets;
+  buckets.reserve(shard.table.size());
+  for (auto &[key, bucket] : shard.table) {
+    buckets.emplace_back(bucket.value(), key);
+  }
+  std::sort(buckets.begin(), buckets.end(), [](auto &a, auto &b) {
+    return a.first < b.first;
+  });
+
+  int64_t target_bytes =
+      max_shard_bytes_ / 4 * 3 - TpnBucket::Arena::chunk_bytes();
+  for (auto &[value, key] : buckets) {
+    if (shard.used_bytes() <= target_bytes) {
+      break;
+    }
+    auto it = shard.table.find(key);
+    it->second.clear();
+    shard.evicted_buckets++;
+    shard.table.erase(it);
+  }
+
+  for (auto &[key, bucket] : shard.table) {
+    bucket.age();
+  }
+}
+
+// Each slot of the hash table also has a one byte control word.
+static constexpr int64_t SLOT_BYTES =
+    sizeof(absl::flat_hash_map<TpnBucketKey, TpnBucket>::value_type) + 1;
+
+int64_t TpnTable::Shard::bytes() const {
+  return (int64_t)table.capacity() * SLOT_BYTES + arena.bytes();
+}
+
+int64_t TpnTable::Shard::used_bytes() const {
+  return (int64_t)table.capacity() * SLOT_BYTES +
+         arena.size() * TpnBucket::Arena::block_bytes();
 }
 
 TpnTable::Stats TpnTable::stats() const {
   Stats stats;
 
-  stats.lookup_misses += lookup_misses_;
-  stats.insert_misses += insert_misses_;
-
-  for (auto &entry : table_) {
-    auto &bucket_stats = entry.second.stats();
-    stats.buckets++;
-    stats.entries += bucket_stats.entries;
-    stats.lookup_hits += bucket_stats.lookup_hits;
-    stats.lookup_misses += bucket_stats.lookup_misses;
-    stats.lookup_reads += bucket_stats.lookup_reads;
-    stats.insert_hits += bucket_stats.insert_hits;
-    stats.insert_misses += bucket_stats.insert_misses;
-    stats.insert_reads += bucket_stats.insert_reads;
+  for (int i = 0; i < num_shards_; i++) {
+    Shard                       &shard = shards_[i];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+    if (concurrent()) {
+      lock.lock();
+    }
+    stats.buckets += (int64_t)shard.table.size();
+    for (auto &[key, bucket] : shard.table) {
+      stats.entries += bucket.entries();
+    }
+    stats.bytes += shard.bytes();
+    stats.evicted_buckets += shard.evicted_buckets;
   }
 
   return stats;
 }
 
+void TpnTable::clear() {
+  for (int i = 0; i < num_shards_; i++) {
+    Shard                       &shard = shards_[i];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+    if (concurrent()) {
+      lock.lock();
+    }
+    // Clearing a large hash table releases its memory, so entries are erased
+    // one by one instead, keeping the capacity for the table to refill
+    // without allocating.
+    for (auto it = shard.table.begin(); it != shard.table.end();) {
+      shard.table.erase(it++);
+    }
+    shard.arena.clear();
+    shard.evicted_buckets = 0;
+  }
+}
+
 void TpnTable::check_invariants() const {
-  for (auto &entry : table_) {
-    entry.second.check_invariants();
+  for (int i = 0; i < num_shards_; i++) {
+    Shard                       &shard = shards_[i];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+    if (concurrent()) {
+      lock.lock();
+    }
+    for (auto &entry : shard.table) {
+      entry.second.check_invariants();
+    }
   }
 }
 
+void TpnTable::Stats::add_counters(const TpnBucket::Stats &stats) {
+  lookup_hits += stats.lookup_hits;
+  lookup_misses += stats.lookup_misses;
+  lookup_reads += stats.lookup_reads;
+  insert_hits += stats.insert_hits;
+  insert_misses += stats.insert_misses;
+  insert_reads += stats.insert_reads;
+}
+
+void TpnTable::Stats::add_counters(const Stats &stats) {
+  lookup_hits += stats.lookup_hits;
+  lookup_misses += stats.lookup_misses;
+  lookup_reads += stats.lookup_reads;
+  insert_hits += stats.insert_hits;
+  insert_misses += stats.insert_misses;
+  insert_reads += stats.insert_reads;
+}
+
 void TpnBucket::Bounds::tighten(TpnBucket::Bounds bounds) {
   assert(bounds.lower_bound <= upper_bound);
   assert(bounds.upper_bound >= lower_bound);
@@ -248,12 +682,26 @@ TpnBucketKey::TpnBucketKey(Seat next_seat, const Hands &hands)
   for (Seat seat = LAST_SEAT; seat >= FIRST_SEAT; seat--) {
     Cards hand = hands.hand(seat);
     for (Suit suit = FIRST_SUIT; suit <= LAST_SUIT; suit++) {
-      bits_ = (bits_ << 3) | hand.intersect(suit).count();
+      bits_ = (bits_ << 3) + hand.intersect(suit).count();
     }
   }
 }
 
-TpnTable::TpnTable(const Game &game)
-    : game_(game),
-      lookup_misses_(0),
-      insert_misses_(0) {}
+TpnTable::TpnTable(int num_shards)
+    : num_shards_(std::max(1, num_shards)),
+      shards_(new Shard[num_shards_]),
+      max_shard_bytes_(0) {}
+
+void TpnTable::enable_memory_budget(int64_t max_bytes) {
+  if (max_bytes <= 0) {
+    max_shard_bytes_ = 0;
+    return;
+  }
+  max_bytes        = std::max(max_bytes, min_memory_budget());
+  max_shard_bytes_ = max_bytes / num_shards_;
+}
+
+int64_t TpnTable::min_memory_budget() const {
+  return (int64_t)num_shards_ * MIN_SHARD_CHUNKS *
+         TpnBucket::Arena::chunk_bytes();
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 #include "game_model.h"
@@ -10,9 +13,13 @@ class TpnBucket {
 public:
   static constexpr int MIN_BOUND = 0;
   static constexpr int MAX_BOUND = 13;
+  // Entries may store the (normalized) index of the best play at the position,
+  // to be tried first when the entry's bounds cause no cutoff.
+  static constexpr int NO_PLAY = -1;
 
+  // Lookup and insert counters. These are accumulated by the caller (rather
+  // than by the bucket) so that buckets may be shared between threads.
   struct Stats {
-    int64_t entries       = 0;
     int64_t lookup_hits   = 0;
     int64_t lookup_misses = 0;
     int64_t lookup_reads  = 0;
@@ -21,20 +28,46 @@ public:
     int64_t insert_reads  = 0;
   };
 
-  const Stats &stats() const { return stats_; }
+  class Arena;
 
+  // Creates an empty bucket whose entries are allocated from the given arena.
+  explicit TpnBucket(Arena &arena, int tricks_left = 0);
+
+  int64_t entries() const { return entries_count_; }
+
+  // The value of keeping the bucket in a memory-bounded table. Buckets for
+  // positions with more tricks left save exponentially more search, and
+  // buckets which are frequently hit are more likely to be hit again.
+  int64_t value() const { return (hits_ + 1) << tricks_left_; }
+  // Halves the hit count, so that the value reflects recent use.
+  void age() { hits_ /= 2; }
+
+  // If no entry causes a cutoff, the best play is set to the best play of the
+  // most specific entry matching the hands (or NO_PLAY).
   bool lookup(
       const Hands &hands,
       int          alpha,
       int          beta,
       int         &score,
-      Cards       &winners_by_rank
+      Cards       &winners_by_rank,
+      Stats       &stats,
+      int         *best_play = nullptr
   ) const;
 
-  void insert(const Hands &partition, int lower_bound, int upper_bound);
+  void insert(
+      const Hands &partition,
+      int          lower_bound,
+      int          upper_bound,
+      Stats       &stats,
+      int          best_play = NO_PLAY
+  );
+  // Returns all entries to the arena.
+  void clear();
   void check_invariants() const;
 
 private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
   struct Bounds {
     int8_t lower_bound;
     int8_t upper_bound;
@@ -46,35 +79,125 @@ private:
     bool tighter_or_eq(Bounds bounds) const;
   };
 
-  struct Entry {
-    Hands              partition;
-    Bounds             bounds;
-    std::vector<Entry> children;
+  // A block of up to four sibling entries in the partition tree. Partitions
+  // are stored as structure-of-arrays (one lane per entry for each seat), so
+  // that all entries in a block may be tested with a few vector instructions.
+  // The children of an entry (the entries it generalizes) and the siblings
+  // following a block form singly linked lists of blocks in the arena.
+  struct alignas(32) Block {
+    static constexpr int SIZE = 4;
+
+    uint64_t partitions[4][SIZE];
+    Bounds   bounds[SIZE];
+    uint32_t first_child[SIZE];
+    uint32_t next;
+    uint8_t  size;
+    // The best play of each entry, packed in six bits per entry so that blocks
+    // stay within 160 bytes.
+    uint8_t  best_plays[3];
+
+    Hands partition(int i) const;
+    int   best_play(int i) const;
+    void  set_best_play(int i, int best_play);
+    void  set(
+        int          i,
+        const Hands &partition,
+        Bounds       bounds,
+        uint32_t     children,
+        int          best_play
+    );
+    void  copy(int i, const Block &src, int src_i);
+    // Removes an entry by moving the last entry in its place.
+    void  remove_at(int i);
   };
 
   bool lookup(
-      const std::vector<Entry> &entries,
-      const Hands              &hands,
-      int                       alpha,
-      int                       beta,
-      int                      &score,
-      Cards                    &winners_by_rank
+      uint32_t     first,
+      const Hands &hands,
+      int          alpha,
+      int          beta,
+      int         &score,
+      Cards       &winners_by_rank,
+      Stats       &stats,
+      int         &best_play
   ) const;
 
-  void insert(std::vector<Entry> &ents, const Hands &partition, Bounds bounds);
-  void transfer_generalized(std::vector<Entry> &src, Entry &dest) const;
-  void tighten_child_bounds(Entry &entry);
-  void check_invariants(const Entry &entry) const;
+  void insert(
+      uint32_t    &first,
+      const Hands &partition,
+      Bounds       bounds,
+      Stats       &stats,
+      int          best_play
+  );
+  void append(
+      uint32_t    &first,
+      const Hands &partition,
+      Bounds       bounds,
+      uint32_t     children,
+      int          best_play
+  );
+  void     append_list(uint32_t &first, uint32_t list);
+  uint32_t remove_generalized(uint32_t &first, const Hands &partition);
+  void     tighten_child_bounds(Bounds bounds, uint32_t &first, Stats &stats);
+  void     free_all(uint32_t first);
+  void     check_children(const Block &block, int i) const;
+
+  Arena          *arena_;
+  uint32_t        first_;
+  int64_t         entries_count_;
+  mutable int64_t hits_;
+  int8_t          tricks_left_;
+};
+
+// Storage for the entries of the buckets in a table. Blocks of entries are
+// allocated in fixed-size chunks of contiguous memory and addressed by 32-bit
+// indices, and freed blocks are reused before new chunks are allocated. Arenas
+// are not thread-safe.
+class TpnBucket::Arena {
+public:
+  Arena() = default;
+  Arena(const Arena &)            = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // Number of blocks in use.
+  int64_t size() const { return size_; }
+  // Memory allocated for blocks, whether in use or free.
+  int64_t bytes() const;
+  // Frees all blocks, keeping the memory allocated for reuse.
+  void    clear();
+
+  static int64_t block_bytes() { return sizeof(Block); }
+  static int64_t chunk_bytes() { return CHUNK_SIZE * sizeof(Block); }
+
+private:
+  friend class TpnBucket;
+
+  static constexpr int      CHUNK_BITS = 8;
+  static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+
+  Block &operator[](uint32_t i) {
+    return chunks_[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)];
+  }
+  const Block &operator[](uint32_t i) const {
+    return chunks_[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)];
+  }
 
-  static void remove_at(std::vector<Entry> &entries, std::size_t index);
+  uint32_t allocate();
+  void     free(uint32_t i);
 
-  std::vector<Entry> entries_;
-  mutable Stats      stats_;
+  std::vector<std::unique_ptr<Block[]>> chunks_;
+  uint32_t                              free_list_ = NONE;
+  uint32_t                              next_      = 0;
+  int64_t                               size_      = 0;
 };
 
 class TpnBucketKey {
 public:
   TpnBucketKey(Seat next_seat, const Hands &hands);
+  // The key of the game's position, which the game keeps up to date.
+  explicit TpnBucketKey(const Game &game) : bits_(game.shape()) {}
+
+  uint64_t bits() const { return bits_; }
 
   template <typename H> friend H AbslHashValue(H h, const TpnBucketKey &k) {
     return H::combine(std::move(h), k.bits_);
@@ -91,28 +214,86 @@ private:
 class TpnTable {
 public:
   struct Stats {
-    int64_t buckets       = 0;
-    int64_t entries       = 0;
-    int64_t lookup_hits   = 0;
-    int64_t lookup_misses = 0;
-    int64_t lookup_reads  = 0;
-    int64_t insert_hits   = 0;
-    int64_t insert_misses = 0;
-    int64_t insert_reads  = 0;
+    int64_t buckets         = 0;
+    int64_t entries         = 0;
+    int64_t bytes           = 0;
+    int64_t evicted_buckets = 0;
+    int64_t lookup_hits     = 0;
+    int64_t lookup_misses   = 0;
+    int64_t lookup_reads    = 0;
+    int64_t insert_hits     = 0;
+    int64_t insert_misses   = 0;
+    int64_t insert_reads    = 0;
+
+    void add_counters(const TpnBucket::Stats &stats);
+    void add_counters(const Stats &stats);
   };
 
-  TpnTable(const Game &game);
+  // Number of shards used by tables shared between threads.
+  static constexpr int CONCURRENT_SHARDS = 64;
 
-  bool  lookup(int alpha, int beta, int &score, Cards &winners_by_rank) const;
-  void  insert(Cards winners_by_rank, int lower_bound, int upper_bound);
+  // Creates a table split into the given number of shards. Tables with more
+  // than one shard guard each shard with a lock, and may be shared between
+  // threads. Single shard tables are not thread-safe.
+  explicit TpnTable(int num_shards = 1);
+
+  // Number of arena chunks each shard may hold under the smallest budget.
+  // Smaller budgets are raised to this, since eviction must leave room for a
+  // shard's arena to allocate another chunk.
+  static constexpr int MIN_SHARD_CHUNKS = 4;
+
+  // Bounds the (approximate) memory used by the table. When the budget is
+  // exceeded, the least valuable buckets are evicted until the table is back
+  // below three quarters of the budget. Zero means unbounded. Budgets below
+  // min_memory_budget() are raised to it.
+  void    enable_memory_budget(int64_t max_bytes);
+  int64_t min_memory_budget() const;
+
+  // Removes all entries, keeping the memory allocated for reuse.
+  void clear();
+
+  // If the position's bounds cause no cutoff, the best play is set to the best
+  // play stored with the most specific entry for the position, if any.
+  bool lookup(
+      const Game          &game,
+      int                  alpha,
+      int                  beta,
+      int                 &score,
+      Cards               &winners_by_rank,
+      TpnBucket::Stats    &stats,
+      std::optional<Card> *best_play = nullptr
+  ) const;
+  void insert(
+      const Game         &game,
+      Cards               winners_by_rank,
+      int                 lower_bound,
+      int                 upper_bound,
+      TpnBucket::Stats   &stats,
+      std::optional<Card> best_play = std::nullopt
+  );
   Stats stats() const;
   void  check_invariants() const;
 
 private:
   using HashTable = absl::flat_hash_map<TpnBucketKey, TpnBucket>;
 
-  const Game &game_;
-  HashTable   table_;
-  int64_t     lookup_misses_;
-  int64_t     insert_misses_;
+  struct Shard {
+    std::mutex       mutex;
+    TpnBucket::Arena arena;
+    HashTable        table;
+    int64_t          evicted_buckets = 0;
+
+    // Memory allocated by the shard.
+    int64_t bytes() const;
+    // Memory used by the shard, excluding free nodes in the arena.
+    int64_t used_bytes() const;
+  };
+
+  Shard &shard(const TpnBucketKey &key) const;
+  bool   concurrent() const { return num_shards_ > 1; }
+  void   evict(Shard &shard);
+
+  int                      num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+  int64_t                  max_shard_bytes_;
 };
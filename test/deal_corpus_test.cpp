@@ -0,0 +1,121 @@
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "deal_corpus.h"
+#include "mapped_file.h"
+#include "random.h"
+
+static void expect_same_game(const Game &g1, const Game &g2) {
+  EXPECT_EQ(g1.trump_suit(), g2.trump_suit());
+  EXPECT_EQ(g1.lead_seat(), g2.lead_seat());
+  EXPECT_EQ(g1.hands(), g2.hands());
+}
+
+TEST(DealCorpus, encode_decode) {
+  for (int seed = 0; seed < 50; seed++) {
+    Game    g = Random(seed).random_game(seed % 13 + 1);
+    uint8_t record[DealCorpus::RECORD_SIZE];
+    DealCorpus::encode(g, record);
+    SCOPED_TRACE(::testing::Message() << "seed " << seed);
+    expect_same_game(DealCorpus::decode(record), g);
+  }
+}
+
+TEST(DealCorpus, encode_layout) {
+  Game    g(NO_TRUMP, SOUTH, Hands("...2/...3/...4/A..."));
+  uint8_t record[DealCorpus::RECORD_SIZE];
+  DealCorpus::encode(g, record);
+
+  // 2♣, 3♣ and 4♣ are cards 0, 4 and 8, and A♠ is card 51.
+  uint8_t expected[DealCorpus::RECORD_SIZE] = {};
+  expected[0]  = 0x11;
+  expected[1]  = 0x01;
+  expected[6]  = 0x08;
+  expected[8]  = NORTH;
+  expected[9]  = EAST;
+  expected[19] = SOUTH << 6;
+  expected[20] = NO_TRUMP;
+  expected[21] = SOUTH;
+  for (int i = 0; i < (int)DealCorpus::RECORD_SIZE; i++) {
+    EXPECT_EQ(record[i], expected[i]) << "byte " << i;
+  }
+}
+
+TEST(DealCorpus, encode_started) {
+  Game g = Random(0).random_game(5);
+  g.play(g.valid_plays_all().lowest());
+  uint8_t record[DealCorpus::RECORD_SIZE];
+  EXPECT_THROW(DealCorpus::encode(g, record), std::runtime_error);
+}
+
+TEST(DealCorpus, decode_invalid) {
+  uint8_t record[DealCorpus::RECORD_SIZE];
+  DealCorpus::encode(Random(0).random_game(5), record);
+  record[20] = 5;
+  EXPECT_THROW(DealCorpus::decode(record), std::runtime_error);
+
+  // Gives every card to West, so the hands are not the same size.
+  DealCorpus::encode(Random(0).random_game(5), record);
+  for (int i = 7; i < 20; i++) {
+    record[i] = 0;
+  }
+  EXPECT_THROW(DealCorpus::decode(record), std::runtime_error);
+}
+
+TEST(DealCorpus, file) {
+  auto path = std::filesystem::temp_directory_path() / "deal_corpus_test.bin";
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    DealCorpus::write_header(ofs);
+    for (int seed = 0; seed < 10; seed++) {
+      DealCorpus::write_game(ofs, Random(seed).random_game(13));
+    }
+  }
+
+  DealCorpus corpus(path.string());
+  ASSERT_EQ(corpus.size(), 10);
+  for (int seed = 0; seed < 10; seed++) {
+    expect_same_game(corpus.game(seed), Random(seed).random_game(13));
+  }
+
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::app);
+    ofs.put(0);
+  }
+  EXPECT_THROW(DealCorpus(path.string()), std::runtime_error);
+
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << "S N AKQJ.../T987.../6543.../2...AKQ\n";
+  }
+  EXPECT_THROW(DealCorpus(path.string()), std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+#ifndef _WIN32
+TEST(MappedFile, pipe) {
+  // A pipe cannot be mapped, so is read instead.
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  std::string contents(100000, 'x');
+  std::thread writer([&]() {
+    ASSERT_EQ(
+        write(fds[1], contents.data(), contents.size()),
+        (ssize_t)contents.size()
+    );
+    close(fds[1]);
+  });
+  MappedFile file(std::format("/dev/fd/{}", fds[0]));
+  writer.join();
+  close(fds[0]);
+  ASSERT_EQ(file.size(), contents.size());
+  EXPECT_EQ(std::string((const char *)file.data(), file.size()), contents);
+}
+#endif
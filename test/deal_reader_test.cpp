@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "deal_reader.h"
+
+static std::vector<Game> read_all(std::string_view text, DealFormat format) {
+  DealReader          reader(text, format);
+  std::vector<Game>   games;
+  std::optional<Game> game;
+  while (reader.next(game)) {
+    games.push_back(*game);
+  }
+  return games;
+}
+
+static void expect_game(
+    const Game      &game,
+    Suit             trump_suit,
+    Seat             lead_seat,
+    std::string_view hands
+) {
+  EXPECT_EQ(game.trump_suit(), trump_suit);
+  EXPECT_EQ(game.lead_seat(), lead_seat);
+  EXPECT_EQ(game.hands(), Hands(hands));
+}
+
+TEST(DealReader, parse_deal_format) {
+  EXPECT_EQ(parse_deal_format("text"), FORMAT_TEXT);
+  EXPECT_EQ(parse_deal_format("pbn"), FORMAT_PBN);
+  EXPECT_EQ(parse_deal_format("lin"), FORMAT_LIN);
+  EXPECT_THROW(parse_deal_format("xml"), std::runtime_error);
+}
+
+TEST(DealReader, text) {
+  auto games = read_all(
+      "S N A2.../93.../5.2../6.3..\r\n"
+      "\n"
+      "NT W A.../93.../5.2../6.3.. 2S",
+      FORMAT_TEXT
+  );
+  ASSERT_EQ(games.size(), 2);
+  expect_game(games[0], SPADES, NORTH, "A2.../93.../5.2../6.3..");
+  EXPECT_EQ(games[1].trump_suit(), NO_TRUMP);
+  EXPECT_EQ(games[1].next_seat(), NORTH);
+}
+
+TEST(DealReader, pbn) {
+  auto games = read_all(
+      "% PBN 2.1\n"
+      "[Event \"Test\"]\n"
+      "[Board \"1\"]\n"
+      "[Dealer \"N\"]\n"
+      "[Deal \"N:AKQJ.AKQ.AKQ.AKQ T987.JT9.JT9.JT9 6543.876.876.876 "
+      "2.5432.5432.5432\"]\n"
+      "[Declarer \"S\"]\n"
+      "[Contract \"4HX\"]\n"
+      "[Auction \"N\"]\n"
+      "1C Pass 1H Pass\n"
+      "4H Pass Pass X\n"
+      "Pass Pass Pass\n"
+      "{ A comment, [Deal \"ignored\"]\n"
+      "  spanning lines. }\n"
+      "\n"
+      "[Board \"2\"]\n"
+      "[Deal \"E:AKQJ.AKQ.AKQ.AKQ T987.JT9.JT9.JT9 6543.876.876.876 "
+      "2.5432.5432.5432\"]\n"
+      "[Declarer \"\"]\n"
+      "[Contract \"Pass\"]\n"
+      "\n"
+      "[Board \"3\"]\n"
+      "[Deal \"W:A2... 93... 5.2.. 6.3..\"]\n"
+      "[Declarer \"E\"]\n"
+      "[Contract \"1NT\"]\n",
+      FORMAT_PBN
+  );
+  ASSERT_EQ(games.size(), 2);
+  expect_game(
+      games[0],
+      HEARTS,
+      WEST,
+      "2.5432.5432.5432/AKQJ.AKQ.AKQ.AKQ/T987.JT9.JT9.JT9/6543.876.876.876"
+  );
+  expect_game(games[1], NO_TRUMP, SOUTH, "A2.../93.../5.2../6.3..");
+}
+
+TEST(DealReader, lin) {
+  auto games = read_all(
+      "pn|a,b,c,d|st||md|3S2H5432D5432C5432,SAKQJHAKQDAKQCAKQ,"
+      "ST987HJT9DJT9CJT9,|sv|o|ah|Board 1|mb|1C|mb|p|mb|1h!|mb|p|mb|4H|mb|p|"
+      "mb|p|mb|d|mb|p|mb|p|mb|p|pc|SA|pg||\n"
+      "qx|o2|md|1S2H5432D5432C5432,SAKQJHAKQDAKQCAKQ,ST987HJT9DJT9CJT9,"
+      "S6543H876D876C876|mb|p|mb|p|mb|p|mb|p|pg||\n"
+      "qx|o3|md|2S6H3,SAH2,S2D5,S5C2|mb|1N|mb|2S|mb|p|mb|p|mb|3N|mb|p|mb|p|"
+      "mb|p|\n",
+      FORMAT_LIN
+  );
+  ASSERT_EQ(games.size(), 2);
+  expect_game(
+      games[0],
+      HEARTS,
+      WEST,
+      "AKQJ.AKQ.AKQ.AKQ/T987.JT9.JT9.JT9/6543.876.876.876/2.5432.5432.5432"
+  );
+  // West deals and opens 1NT, then bids 3NT over North's 2S.
+  expect_game(games[1], NO_TRUMP, NORTH, "A.2../2..5./5...2/6.3..");
+}
+
+TEST(DealReader, errors) {
+  EXPECT_THROW(
+      read_all(
+          "[Deal \"N:AKQ\"]\n[Declarer \"S\"]\n[Contract \"4H\"]\n",
+          FORMAT_PBN
+      ),
+      Parser::Error
+  );
+  EXPECT_THROW(read_all("md|5SA,SK,SQ,|mb|1S|", FORMAT_LIN), Parser::Error);
+}
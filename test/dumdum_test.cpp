@@ -0,0 +1,184 @@
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <vector>
+
+#include "dumdum.h"
+#include "random.h"
+#include "solver.h"
+#include "table_solver.h"
+
+// Counts the allocations made by the whole test binary.
+static std::atomic<int64_t> num_allocations = 0;
+
+void *operator new(std::size_t size) {
+  num_allocations++;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+  num_allocations++;
+  std::size_t a = (std::size_t)align;
+  if (void *p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+static dumdum_game to_dumdum_game(const Game &g) {
+  dumdum_game game = {
+      .hands  = {},
+      .strain = g.trump_suit(),
+      .leader = g.lead_seat(),
+  };
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    game.hands[seat] = g.hand(seat).bits();
+  }
+  return game;
+}
+
+TEST(Dumdum, card) {
+  EXPECT_EQ(DUMDUM_CARD(12, DUMDUM_SPADES), Cards({"AS"}).bits());
+  EXPECT_EQ(DUMDUM_CARD(0, DUMDUM_CLUBS), Cards({"2C"}).bits());
+  EXPECT_EQ(DUMDUM_CARD(8, DUMDUM_HEARTS), Cards({"TH"}).bits());
+}
+
+TEST(Dumdum, solve) {
+  for (int seed = 0; seed < 20; seed++) {
+    Game          g    = Random(seed).random_game(5);
+    dumdum_game   game = to_dumdum_game(g);
+    dumdum_result result;
+    ASSERT_EQ(dumdum_solve(&game, &result), DUMDUM_OK);
+
+    auto r = Solver(g).solve();
+    EXPECT_EQ(result.tricks_ns, r.tricks_taken_by_ns);
+    EXPECT_EQ(result.tricks_ew, r.tricks_taken_by_ew);
+  }
+}
+
+TEST(Dumdum, solve_invalid) {
+  Game        g    = Random(0).random_game(5);
+  dumdum_game game = to_dumdum_game(g);
+
+  dumdum_result result;
+  EXPECT_EQ(dumdum_solve(&game, nullptr), DUMDUM_ERROR_INVALID_ARGUMENT);
+
+  dumdum_game bad_strain = game;
+  bad_strain.strain      = 5;
+  EXPECT_EQ(dumdum_solve(&bad_strain, &result), DUMDUM_ERROR_INVALID_GAME);
+
+  dumdum_game bad_card = game;
+  bad_card.hands[0] |= 1ull << 60;
+  EXPECT_EQ(dumdum_solve(&bad_card, &result), DUMDUM_ERROR_INVALID_GAME);
+
+  dumdum_game overlapping = game;
+  overlapping.hands[1] |= overlapping.hands[0];
+  EXPECT_EQ(dumdum_solve(&overlapping, &result), DUMDUM_ERROR_INVALID_GAME);
+
+  EXPECT_STREQ(
+      dumdum_status_message(DUMDUM_ERROR_INVALID_GAME), "invalid game"
+  );
+}
+
+TEST(Dumdum, solve_all_plays) {
+  Game                            g    = Random(1).random_game(5);
+  dumdum_game                     game = to_dumdum_game(g);
+  dumdum_result                   result;
+  dumdum_play                     plays[13];
+  int                             num_plays;
+  std::vector<Solver::PlayResult> expected;
+  ASSERT_EQ(
+      dumdum_solve_all_plays(&game, &result, plays, &num_plays), DUMDUM_OK
+  );
+
+  auto r = Solver(g).solve_all_plays(expected);
+  EXPECT_EQ(result.tricks_ns, r.tricks_taken_by_ns);
+  ASSERT_EQ(num_plays, (int)expected.size());
+  for (int i = 0; i < num_plays; i++) {
+    EXPECT_EQ(plays[i].card, Cards().with(expected[i].card).bits());
+    EXPECT_EQ(plays[i].tricks_ns, expected[i].tricks_taken_by_ns);
+    EXPECT_EQ(plays[i].tricks_ew, expected[i].tricks_taken_by_ew);
+  }
+}
+
+TEST(Dumdum, solve_table) {
+  Hands    hands = Random(2).random_deal(5);
+  uint64_t masks[4];
+  for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+    masks[seat] = hands.hand(seat).bits();
+  }
+  dumdum_table table;
+  ASSERT_EQ(dumdum_solve_table(masks, &table), DUMDUM_OK);
+
+  auto r = TableSolver(hands).solve();
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      EXPECT_EQ(table.tricks[strain][seat], r.tricks(strain, seat));
+    }
+  }
+}
+
+TEST(Dumdum, solve_batch) {
+  std::vector<dumdum_game> games;
+  for (int seed = 0; seed < 50; seed++) {
+    games.push_back(to_dumdum_game(Random(seed).random_game(5)));
+  }
+  games[10].leader = 4;
+
+  dumdum_pool *pool = dumdum_pool_create(4, 0);
+  ASSERT_NE(pool, nullptr);
+  // The pool's solvers are reused from one batch to the next.
+  for (int batch = 0; batch < 2; batch++) {
+    std::vector<dumdum_result> results(games.size());
+    ASSERT_EQ(
+        dumdum_solve_batch(pool, games.data(), games.size(), results.data()),
+        DUMDUM_ERROR_INVALID_GAME
+    );
+    for (int seed = 0; seed < 50; seed++) {
+      if (seed == 10) {
+        EXPECT_EQ(results[seed].tricks_ns, -1);
+        continue;
+      }
+      auto r = Solver(Random(seed).random_game(5)).solve();
+      EXPECT_EQ(results[seed].tricks_ns, r.tricks_taken_by_ns);
+      EXPECT_EQ(results[seed].tricks_ew, r.tricks_taken_by_ew);
+    }
+  }
+  EXPECT_EQ(dumdum_solve_batch(pool, nullptr, 0, nullptr), DUMDUM_OK);
+  dumdum_pool_destroy(pool);
+}
+
+TEST(Dumdum, solve_batch_no_allocations) {
+  std::vector<dumdum_game> games;
+  for (int seed = 0; seed < 50; seed++) {
+    games.push_back(to_dumdum_game(Random(seed).random_game(8)));
+  }
+  std::vector<dumdum_result> results(games.size());
+
+  // With one thread, the second batch's games have all been solved by the
+  // same solver in the first.
+  dumdum_pool *pool = dumdum_pool_create(1, 0);
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(
+      dumdum_solve_batch(pool, games.data(), games.size(), results.data()),
+      DUMDUM_OK
+  );
+  int64_t before = num_allocations;
+  ASSERT_EQ(
+      dumdum_solve_batch(pool, games.data(), games.size(), results.data()),
+      DUMDUM_OK
+  );
+  EXPECT_EQ(num_allocations - before, 0);
+  dumdum_pool_destroy(pool);
+}
@@ -82,3 +82,71 @@ TEST(fast_tricks, random) {
     }
   }
 }
+
+void test_sure_tricks(
+    const char *hands_str, Suit trump_suit, int exp_sure_tricks, Cards exp_wbr
+) {
+  Hands hands(hands_str);
+  int   sure_tricks;
+  Cards winners_by_rank;
+  estimate_sure_tricks(hands, WEST, trump_suit, sure_tricks, winners_by_rank);
+  EXPECT_EQ(sure_tricks, exp_sure_tricks);
+  EXPECT_EQ(winners_by_rank, exp_wbr);
+}
+
+TEST(sure_tricks, empty) {
+  test_sure_tricks(".../.../.../...", NO_TRUMP, 0, Cards());
+}
+
+TEST(sure_tricks, top_trumps) {
+  // North's AK each win a trick, but South's Q may fall under them.
+  test_sure_tricks("32.../AK.../54.../Q6...", SPADES, 2, Cards("AK..."));
+  test_sure_tricks("32.../A6.../54.../KQ...", SPADES, 2, Cards("AKQ..."));
+  test_sure_tricks("A2.../K6.../54.../Q7...", SPADES, 0, Cards());
+}
+
+TEST(sure_tricks, current_trick) {
+  test_sure_tricks("...Q2/...AK/...43/...65", NO_TRUMP, 1, Cards("...A"));
+  test_sure_tricks("Q...2/A...K/4...3/5...6", NO_TRUMP, 1, Cards("A...AK"));
+  // The leader may lead a suit which partner may ruff.
+  test_sure_tricks(".2..2/.A..K/2...3/.3..4", SPADES, 0, Cards());
+  test_sure_tricks(".2..2/.A..K/..4.3/.3..5", SPADES, 1, Cards(".A..AK"));
+}
+
+TEST(sure_tricks, later_trick) {
+  // West may lead a club to East, but the spade ace takes a later trick.
+  test_sure_tricks("Q...2/A...3/4...K/5...6", NO_TRUMP, 1, Cards("A...AK"));
+  // East's clubs take every trick.
+  test_sure_tricks("...K2/A...3/...AQ/4...5", NO_TRUMP, 0, Cards());
+  // Not while trumps remain.
+  test_sure_tricks("Q...2/A...3/4...K/5...6", HEARTS, 1, Cards("A...AK"));
+  test_sure_tricks("Q...2/A...3/4...K/5...6", CLUBS, 0, Cards());
+}
+
+TEST(sure_tricks, random) {
+  for (int seed = 0; seed < 100; seed++) {
+    Random random(seed);
+    Game   game = random.random_game(6);
+    Solver solver(game);
+
+    solver.enable_fast_tricks(false);
+
+    auto  result = solver.solve();
+    int   sure_tricks;
+    Cards winners_by_rank;
+
+    estimate_sure_tricks(
+        game.hands(),
+        game.next_seat(),
+        game.trump_suit(),
+        sure_tricks,
+        winners_by_rank
+    );
+
+    if (game.next_seat() == NORTH || game.next_seat() == SOUTH) {
+      ASSERT_LE(sure_tricks, result.tricks_taken_by_ew);
+    } else {
+      ASSERT_LE(sure_tricks, result.tricks_taken_by_ns);
+    }
+  }
+}
@@ -274,13 +274,43 @@ TEST(Game, valid_plays_all) {
   EXPECT_EQ(g.valid_plays_all(), Cards());
 }
 
+TEST(Game, mid_trick) {
+  Game g1(HEARTS, WEST, Hands("A2.../93.../5.2../6.3.."));
+  g1.play(Card("2S"));
+  g1.play(Card("9S"));
+
+  Game g2(
+      HEARTS, WEST, Hands("A.../3.../5.2../6.3.."), {Card("2S"), Card("9S")}
+  );
+  EXPECT_EQ(g2.hands(), g1.hands());
+  EXPECT_EQ(g2.next_seat(), EAST);
+  EXPECT_EQ(g2.tricks_left(), 2);
+  EXPECT_EQ(g2.valid_plays_all(), Cards("5..."));
+
+  g2.play(Card("5S"));
+  g2.play(Card("6S"));
+  EXPECT_EQ(g2.tricks_taken_by_ns(), 1);
+  EXPECT_EQ(g2.next_seat(), NORTH);
+
+  EXPECT_THROW(
+      Game(
+          HEARTS,
+          WEST,
+          Hands("A.../3.../5.../6.3.."),
+          {Card("2S"), Card("9S"), Card("2H")}
+      ),
+      std::runtime_error
+  );
+}
+
 void test_play_unplay_dfs(Game &g) {
-  bool  finished           = g.finished();
-  Seat  next_seat          = g.next_seat();
-  int   trick_count        = g.tricks_taken();
-  int   tricks_taken_by_ew = g.tricks_taken_by_ew();
-  int   tricks_taken_by_ns = g.tricks_taken_by_ns();
-  Cards hands[4];
+  bool     finished           = g.finished();
+  Seat     next_seat          = g.next_seat();
+  int      trick_count        = g.tricks_taken();
+  int      tricks_taken_by_ew = g.tricks_taken_by_ew();
+  int      tricks_taken_by_ns = g.tricks_taken_by_ns();
+  uint64_t shape              = g.shape();
+  Cards    hands[4];
   for (int i = 0; i < 4; i++) {
     hands[i] = g.hand((Seat)i);
   }
@@ -299,6 +329,7 @@ void test_play_unplay_dfs(Game &g) {
     EXPECT_EQ(
         g.tricks_taken_by_ew() + g.tricks_taken_by_ns(), g.tricks_taken()
     );
+    EXPECT_EQ(g.shape(), shape);
     for (int j = 0; j < 4; j++) {
       EXPECT_EQ(g.hand(Seat(j)), hands[j]);
     }
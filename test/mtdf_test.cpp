@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "mtdf.h"
+#include "parallel_solver.h"
+#include "random.h"
+
+TEST(Mtdf, random) {
+  for (int seed = 0; seed < 100; seed++) {
+    Game   g = Random(seed).random_game(5);
+    Solver s1(g);
+    Solver s2(g);
+    auto   r1 = solve_mtdf(s1, g, estimate_tricks(g));
+    auto   r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns)
+        << "seed " << seed;
+    ASSERT_EQ(r1.tricks_taken_by_ew, r2.tricks_taken_by_ew)
+        << "seed " << seed;
+  }
+}
+
+TEST(Mtdf, guess) {
+  Game   g = Random(123).random_game(5);
+  Solver s(g);
+  auto   expected = s.solve();
+  for (int guess = -1; guess <= g.tricks_max() + 1; guess++) {
+    Solver s1(g);
+    auto   r1 = solve_mtdf(s1, g, guess);
+    ASSERT_EQ(r1.tricks_taken_by_ns, expected.tricks_taken_by_ns)
+        << "guess " << guess;
+  }
+}
+
+TEST(Mtdf, estimate_tricks) {
+  for (int seed = 0; seed < 100; seed++) {
+    Game g = Random(seed).random_game(5);
+    int  estimate = estimate_tricks(g);
+    ASSERT_GE(estimate, 0) << "seed " << seed;
+    ASSERT_LE(estimate, g.tricks_max()) << "seed " << seed;
+  }
+}
+
+TEST(Mtdf, parallel) {
+  for (int seed = 0; seed < 20; seed++) {
+    Game           g = Random(seed).random_game(6);
+    ParallelSolver s1(g, 3);
+    Solver         s2(g);
+    auto           r1 = solve_mtdf(s1, g, estimate_tricks(g));
+    auto           r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns)
+        << "seed " << seed;
+  }
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "par_solver.h"
+#include "random.h"
+#include "table_solver.h"
+
+TEST(ParSolver, contract_score) {
+  EXPECT_EQ(contract_score(1, NO_TRUMP, 7, false), 90);
+  EXPECT_EQ(contract_score(2, CLUBS, 9, false), 110);
+  EXPECT_EQ(contract_score(3, NO_TRUMP, 9, true), 600);
+  EXPECT_EQ(contract_score(4, SPADES, 11, false), 450);
+  EXPECT_EQ(contract_score(6, HEARTS, 12, true), 1430);
+  EXPECT_EQ(contract_score(7, NO_TRUMP, 13, false), 1520);
+  EXPECT_EQ(contract_score(5, CLUBS, 9, false), -300);
+  EXPECT_EQ(contract_score(5, CLUBS, 9, true), -500);
+  EXPECT_EQ(contract_score(4, HEARTS, 6, false), -800);
+  EXPECT_EQ(contract_score(4, HEARTS, 6, true), -1100);
+}
+
+static TableSolver::Result make_table(int ns_tricks, int ew_tricks) {
+  TableSolver::Result table;
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      bool ns = seat == NORTH || seat == SOUTH;
+      table.set_tricks(strain, seat, ns ? ns_tricks : ew_tricks);
+    }
+  }
+  return table;
+}
+
+TEST(ParSolver, par_passed_out) {
+  auto r = ParSolver::par(make_table(6, 6), VUL_NONE, NORTH);
+  EXPECT_EQ(r.contract.level, 0);
+  EXPECT_EQ(r.score_ns, 0);
+  EXPECT_EQ(std::format("{}", r), "pass 0");
+}
+
+TEST(ParSolver, par_game) {
+  auto table = make_table(6, 6);
+  table.set_tricks(SPADES, SOUTH, 10);
+  table.set_tricks(HEARTS, EAST, 8);
+  auto r = ParSolver::par(table, VUL_NONE, NORTH);
+  EXPECT_EQ(std::format("{}", r), "4S S 420");
+}
+
+TEST(ParSolver, par_partscore) {
+  auto table = make_table(6, 6);
+  table.set_tricks(SPADES, WEST, 9);
+  auto r = ParSolver::par(table, VUL_NONE, NORTH);
+  EXPECT_EQ(std::format("{}", r), "3S W -140");
+}
+
+TEST(ParSolver, par_sacrifice) {
+  auto table = make_table(6, 6);
+  table.set_tricks(SPADES, SOUTH, 10);
+  table.set_tricks(HEARTS, EAST, 9);
+  EXPECT_EQ(
+      std::format("{}", ParSolver::par(table, VUL_NONE, NORTH)), "5HX E 300"
+  );
+  EXPECT_EQ(
+      std::format("{}", ParSolver::par(table, VUL_EW, NORTH)), "4S S 420"
+  );
+}
+
+TEST(ParSolver, par_dealer) {
+  // Both sides can make 1NT (with different opening leaders), so the first
+  // side to bid takes the contract.
+  auto table = make_table(7, 7);
+  EXPECT_EQ(
+      std::format("{}", ParSolver::par(table, VUL_NONE, NORTH)), "1NT N 90"
+  );
+  EXPECT_EQ(
+      std::format("{}", ParSolver::par(table, VUL_NONE, EAST)), "1NT W -90"
+  );
+}
+
+TEST(ParSolver, random) {
+  // Deals chosen to solve quickly.
+  const int seeds[] = {25, 29};
+  for (int i = 0; i < 2; i++) {
+    int   seed    = seeds[i];
+    Hands hands   = Random(seed).random_deal(13);
+    Seat  dealer  = (Seat)i;
+    auto  table   = TableSolver(hands).solve();
+    auto  results = ParSolver(hands, dealer).solve();
+    for (int vul = VUL_NONE; vul <= VUL_BOTH; vul++) {
+      SCOPED_TRACE(::testing::Message() << "seed " << seed << " vul " << vul);
+      auto expected = ParSolver::par(table, (Vulnerability)vul, dealer);
+      EXPECT_EQ(results[vul].score_ns, expected.score_ns);
+
+      // The contract found must also achieve par.
+      const auto &c = results[vul].contract;
+      if (c.level > 0) {
+        bool ns         = c.declarer == NORTH || c.declarer == SOUTH;
+        bool vulnerable = vul == VUL_BOTH || vul == (ns ? VUL_NS : VUL_EW);
+        int  tricks     = table.tricks(c.strain, c.declarer);
+        int  score = contract_score(c.level, c.strain, tricks, vulnerable);
+        EXPECT_EQ(results[vul].score_ns, ns ? score : -score);
+      }
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "parallel_solver.h"
+#include "random.h"
+
+TEST(ParallelSolver, random) {
+  for (int seed = 0; seed < 50; seed++) {
+    Game           g = Random(seed).random_game(6);
+    ParallelSolver s1(g, 4);
+    Solver         s2(g);
+    s1.enable_split_min_tricks(2);
+    auto r1 = s1.solve();
+    auto r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns)
+        << "seed " << seed;
+  }
+}
+
+TEST(ParallelSolver, window) {
+  for (int seed = 0; seed < 20; seed++) {
+    Game           g = Random(seed).random_game(5);
+    ParallelSolver s1(g, 3);
+    Solver         s2(g);
+    s1.enable_split_min_tricks(1);
+    auto r2 = s2.solve();
+    for (int alpha = 0; alpha < 5; alpha++) {
+      auto r1 = s1.solve(alpha, alpha + 1);
+      if (r2.tricks_taken_by_ns <= alpha) {
+        ASSERT_LE(r1.tricks_taken_by_ns, alpha) << "seed " << seed;
+      } else {
+        ASSERT_GE(r1.tricks_taken_by_ns, alpha + 1) << "seed " << seed;
+      }
+    }
+  }
+}
@@ -23,3 +23,30 @@ TEST(PlayOrder, order_cards) {
     n++;
   }
 }
+
+TEST(PlayOrder, order_plays_history) {
+  // North discards after West's lead, holding a five in two suits.
+  Parser parser("NT W K.../.5.5./32.../...32 AS");
+  Game   g(parser);
+
+  PlayOrder order;
+  order_plays(g, order);
+  ASSERT_EQ(order.end() - order.begin(), 2);
+  Card first = order.begin()[0], second = order.begin()[1];
+  EXPECT_EQ(first.rank(), second.rank());
+
+  PlayHistory history;
+  history.add_cutoff(g, second);
+  EXPECT_TRUE(history.is_killer(g, second));
+  EXPECT_GT(history.score(g, second), history.score(g, first));
+
+  PlayOrder learned;
+  order_plays(g, learned, &history);
+  ASSERT_EQ(learned.end() - learned.begin(), 2);
+  EXPECT_EQ(learned.begin()[0], second);
+  EXPECT_EQ(learned.begin()[1], first);
+
+  history.clear();
+  EXPECT_FALSE(history.is_killer(g, second));
+  EXPECT_EQ(history.score(g, second), 0);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "random.h"
+#include "search_bench.h"
+#include "solver.h"
+
+static std::vector<Game> random_games() {
+  std::vector<Game> games;
+  for (int seed = 0; seed < 6; seed++) {
+    Game g = Random(seed).random_game(seed < 3 ? 4 : 5);
+    games.emplace_back(seed % 2 ? NO_TRUMP : SPADES, g.lead_seat(), g.hands());
+  }
+  return games;
+}
+
+TEST(SearchBench, run) {
+  auto games   = random_games();
+  auto records = run_search_bench(games, 0);
+
+  // A record for each deal, then each group (4♠, 4NT, 5♠, 5NT), then total.
+  ASSERT_EQ(records.size(), games.size() + 5);
+  int64_t nodes_explored = 0;
+  for (std::size_t i = 0; i < games.size(); i++) {
+    const BenchRecord &deal = records[i];
+    auto               r    = Solver(games[i]).solve();
+    EXPECT_EQ(deal.type, BenchRecord::DEAL);
+    EXPECT_EQ(deal.tricks_taken_by_ns, r.tricks_taken_by_ns);
+    EXPECT_EQ(deal.metrics.deals, 1);
+    if constexpr (SearchCounters::ENABLED) {
+      // The root position is looked up once.
+      int tricks = games[i].tricks_left();
+      EXPECT_EQ(deal.metrics.search_counters.depths[tricks][0].tpn_lookups, 1);
+    }
+    nodes_explored += deal.metrics.nodes_explored;
+  }
+  EXPECT_EQ(records[0].group, "4S");
+  EXPECT_EQ(records[1].group, "4NT");
+
+  std::vector<std::string> groups;
+  for (std::size_t i = games.size(); i < records.size() - 1; i++) {
+    EXPECT_EQ(records[i].type, BenchRecord::GROUP);
+    groups.push_back(records[i].name);
+  }
+  EXPECT_EQ(groups, (std::vector<std::string>{"4S", "4NT", "5S", "5NT"}));
+  EXPECT_EQ(records[games.size()].metrics.deals, 2);
+
+  const BenchRecord &total = records.back();
+  EXPECT_EQ(total.type, BenchRecord::TOTAL);
+  EXPECT_EQ(total.metrics.deals, (int64_t)games.size());
+  EXPECT_EQ(total.metrics.nodes_explored, nodes_explored);
+}
+
+TEST(SearchBench, json) {
+  for (const BenchRecord &record : run_search_bench(random_games(), 0)) {
+    BenchRecord parsed = BenchRecord::from_json(record.to_json());
+    EXPECT_EQ(parsed.type, record.type);
+    EXPECT_EQ(parsed.name, record.name);
+    EXPECT_EQ(parsed.group, record.group);
+    EXPECT_EQ(parsed.tricks_taken_by_ns, record.tricks_taken_by_ns);
+    EXPECT_EQ(parsed.metrics.nodes_explored, record.metrics.nodes_explored);
+    EXPECT_EQ(parsed.metrics.elapsed_us, record.metrics.elapsed_us);
+    EXPECT_EQ(parsed.metrics.tpn_stats.bytes, record.metrics.tpn_stats.bytes);
+    EXPECT_EQ(
+        parsed.metrics.tpn_stats.insert_reads,
+        record.metrics.tpn_stats.insert_reads
+    );
+  }
+
+  EXPECT_THROW(BenchRecord::from_json("{\"type\":\"deal\""), Parser::Error);
+  EXPECT_THROW(
+      BenchRecord::from_json("{\"type\":\"other\"}"), std::runtime_error
+  );
+}
+
+TEST(SearchBench, compare) {
+  auto baseline = run_search_bench(random_games(), 0);
+  auto current  = baseline;
+  EXPECT_TRUE(compare_search_bench(baseline, current, 0.05).empty());
+
+  // Growth within the threshold is not reported, while a changed result is.
+  current[0].metrics.nodes_explored =
+      baseline[0].metrics.nodes_explored * 104 / 100;
+  current[1].tricks_taken_by_ns++;
+  current.back().metrics.elapsed_us += 1000;
+  auto regressions = compare_search_bench(baseline, current, 0.05);
+  ASSERT_EQ(regressions.size(), 2);
+  EXPECT_EQ(regressions[0].name, baseline[1].name);
+  EXPECT_EQ(regressions[0].metric, "tricks_ns");
+  EXPECT_EQ(regressions[1].name, "total");
+  EXPECT_EQ(regressions[1].metric, "elapsed_us");
+
+  // Deals missing from the baseline are ignored.
+  baseline.erase(baseline.begin());
+  current[0].metrics.nodes_explored *= 2;
+  EXPECT_EQ(compare_search_bench(baseline, current, 0.05).size(), 2);
+}
@@ -0,0 +1,281 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "random.h"
+#include "server.h"
+#include "solver.h"
+#include "table_solver.h"
+
+static std::vector<std::string>
+serve(const std::string &requests, int num_threads = 1) {
+  Server server;
+  server.enable_threads(num_threads);
+  std::istringstream in(requests);
+  std::ostringstream out;
+  server.serve(in, out);
+
+  std::vector<std::string> responses;
+  std::istringstream       lines(out.str());
+  for (std::string line; std::getline(lines, line);) {
+    responses.push_back(line);
+  }
+  return responses;
+}
+
+TEST(Server, solve) {
+  auto responses = serve("S N A2.../93.../5.2../6.3..\n");
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_THAT(
+      responses[0],
+      testing::StartsWith("{\"seq\":0,\"tricks_ns\":1,\"tricks_ew\":1,")
+  );
+  EXPECT_THAT(responses[0], testing::EndsWith("}"));
+}
+
+TEST(Server, pipelined) {
+  std::string requests;
+  for (int seed = 0; seed < 50; seed++) {
+    Game g = Random(seed).random_game(5);
+    requests += std::format(
+        "{}solve {} {} {}\n",
+        seed % 2 ? "" : "  ",
+        suit_to_ascii(g.trump_suit()),
+        g.next_seat(),
+        g.hands()
+    );
+  }
+
+  auto responses = serve(requests, 4);
+  ASSERT_EQ(responses.size(), 50);
+  for (int seed = 0; seed < 50; seed++) {
+    auto r = Solver(Random(seed).random_game(5)).solve();
+    EXPECT_THAT(
+        responses[seed],
+        testing::StartsWith(std::format(
+            "{{\"seq\":{},\"tricks_ns\":{},\"tricks_ew\":{},",
+            seed,
+            r.tricks_taken_by_ns,
+            r.tricks_taken_by_ew
+        ))
+    );
+  }
+}
+
+TEST(Server, concurrent_clients) {
+  // Clients served at once share the server's workers, and each receives
+  // only its own responses, in order.
+  Server server;
+  server.enable_threads(3);
+  std::vector<std::string> outputs(4);
+  std::vector<std::thread> threads;
+  for (int client = 0; client < 4; client++) {
+    threads.emplace_back([&, client]() {
+      std::string requests;
+      for (int seed = client; seed < 40; seed += 4) {
+        Game g = Random(seed).random_game(5);
+        requests += std::format(
+            "{} {} {}\n",
+            suit_to_ascii(g.trump_suit()),
+            g.next_seat(),
+            g.hands()
+        );
+      }
+      std::istringstream in(requests);
+      std::ostringstream out;
+      server.serve(in, out);
+      outputs[client] = out.str();
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int client = 0; client < 4; client++) {
+    std::istringstream lines(outputs[client]);
+    std::string        line;
+    int                seq = 0;
+    for (int seed = client; seed < 40; seed += 4, seq++) {
+      ASSERT_TRUE(std::getline(lines, line));
+      auto r = Solver(Random(seed).random_game(5)).solve();
+      EXPECT_THAT(
+          line,
+          testing::StartsWith(std::format(
+              "{{\"seq\":{},\"tricks_ns\":{},\"tricks_ew\":{},",
+              seq,
+              r.tricks_taken_by_ns,
+              r.tricks_taken_by_ew
+          ))
+      );
+    }
+    ASSERT_FALSE(std::getline(lines, line));
+  }
+}
+
+// An output stream buffer whose writes block until released, like a socket
+// whose client has stopped reading.
+class BlockedBuf : public std::streambuf {
+public:
+  void wait_blocked() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return blocked_; });
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+protected:
+  int_type overflow(int_type c) override {
+    block();
+    return c;
+  }
+
+  std::streamsize xsputn(const char *, std::streamsize n) override {
+    block();
+    return n;
+  }
+
+private:
+  void block() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    blocked_ = true;
+    cv_.notify_all();
+    cv_.wait(lock, [this]() { return released_; });
+  }
+
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  bool                    blocked_  = false;
+  bool                    released_ = false;
+};
+
+TEST(Server, client_not_reading) {
+  // A client which stops reading its responses must not hold up the workers
+  // answering other clients.
+  Server server;
+  server.enable_threads(2);
+
+  std::string requests_a;
+  for (int i = 0; i < 10; i++) {
+    requests_a += "S N A2.../93.../5.2../6.3..\n";
+  }
+  BlockedBuf         buf;
+  std::ostream       out_a(&buf);
+  std::istringstream in_a(requests_a);
+  std::thread        client_a([&]() { server.serve(in_a, out_a); });
+  buf.wait_blocked();
+
+  auto client_b = std::async(std::launch::async, [&]() {
+    std::istringstream in(
+        "S N A2.../93.../5.2../6.3..\n"
+        "S N A2.../93.../5.2../6.3..\n"
+        "S N A2.../93.../5.2../6.3..\n"
+    );
+    std::ostringstream out;
+    server.serve(in, out);
+    return out.str();
+  });
+  auto status = client_b.wait_for(std::chrono::seconds(10));
+  buf.release();
+  client_a.join();
+  ASSERT_EQ(status, std::future_status::ready);
+
+  std::istringstream lines(client_b.get());
+  int                count = 0;
+  for (std::string line; std::getline(lines, line); count++) {
+    EXPECT_THAT(
+        line,
+        testing::StartsWith(std::format("{{\"seq\":{},\"tricks_ns\":", count))
+    );
+  }
+  EXPECT_EQ(count, 3);
+}
+
+TEST(Server, mid_trick) {
+  auto responses = serve("H W A.../93.../5.2../6.3.. 2S\n");
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_THAT(
+      responses[0],
+      testing::StartsWith("{\"seq\":0,\"tricks_ns\":2,\"tricks_ew\":0,")
+  );
+}
+
+TEST(Server, plays) {
+  auto responses = serve("plays H W A2.../93.../5.2../6.3..\n");
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_THAT(
+      responses[0],
+      testing::StartsWith(
+          "{\"seq\":0,\"tricks_ns\":1,\"tricks_ew\":1,\"plays\":{\"AS\":1,"
+          "\"2S\":2},"
+      )
+  );
+}
+
+TEST(Server, bound) {
+  auto responses = serve(
+      "bound 1 H W A2.../93.../5.2../6.3..\n"
+      "bound 2 H W A2.../93.../5.2../6.3..\n"
+  );
+  ASSERT_EQ(responses.size(), 2);
+  EXPECT_THAT(
+      responses[0],
+      testing::StartsWith("{\"seq\":0,\"bound\":1,\"at_least\":true,")
+  );
+  EXPECT_THAT(
+      responses[1],
+      testing::StartsWith("{\"seq\":1,\"bound\":2,\"at_least\":false,")
+  );
+}
+
+TEST(Server, bound_out_of_range) {
+  auto responses = serve(
+      "bound 14 H W A2.../93.../5.2../6.3..\n"
+      "bound 99999999999 H W A2.../93.../5.2../6.3..\n"
+  );
+  ASSERT_EQ(responses.size(), 2);
+  EXPECT_THAT(responses[0], testing::StartsWith("{\"seq\":0,\"error\":\""));
+  EXPECT_THAT(responses[1], testing::StartsWith("{\"seq\":1,\"error\":\""));
+}
+
+TEST(Server, table) {
+  Hands hands     = Random(0).random_deal(5);
+  auto  responses = serve(std::format("table {}\n", hands));
+  auto  r         = TableSolver(hands).solve();
+  ASSERT_EQ(responses.size(), 1);
+  std::string expected = "{\"seq\":0,\"table\":{";
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    expected += std::format(
+        "{}\"{}\":[{},{},{},{}]",
+        strain == FIRST_SUIT ? "" : ",",
+        suit_to_ascii(strain),
+        r.tricks(strain, WEST),
+        r.tricks(strain, NORTH),
+        r.tricks(strain, EAST),
+        r.tricks(strain, SOUTH)
+    );
+  }
+  EXPECT_THAT(responses[0], testing::StartsWith(expected + "},"));
+
+  responses = serve(std::format("table {} 2S\n", hands));
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_THAT(responses[0], testing::StartsWith("{\"seq\":0,\"error\":\""));
+}
+
+TEST(Server, error) {
+  auto responses = serve(
+      "X N A2.../93.../5.2../6.3..\n"
+      "S N A2.../93.../5.2../6.3..\n"
+  );
+  ASSERT_EQ(responses.size(), 2);
+  EXPECT_THAT(responses[0], testing::StartsWith("{\"seq\":0,\"error\":\""));
+  EXPECT_THAT(responses[0], testing::Not(testing::HasSubstr("\n")));
+  EXPECT_THAT(responses[1], testing::StartsWith("{\"seq\":1,\"tricks_ns\":"));
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+
+#include "random.h"
+#include "smp_solver.h"
+
+TEST(SmpSolver, random) {
+  for (int seed = 0; seed < 50; seed++) {
+    Game      g = Random(seed).random_game(6);
+    SmpSolver s1(g, 4);
+    Solver    s2(g);
+    auto      r1 = s1.solve();
+    auto      r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns)
+        << "seed " << seed;
+  }
+}
+
+TEST(SmpSolver, resolve) {
+  Game      g = Random(123).random_game(6);
+  SmpSolver s1(g, 3);
+  Solver    s2(g);
+  auto      r2 = s2.solve();
+  for (int i = 0; i < 3; i++) {
+    auto r1 = s1.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns);
+  }
+}
@@ -1,5 +1,6 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <sstream>
 
 #include "random.h"
 #include "solver.h"
@@ -66,6 +67,63 @@ TEST(Solver, fast_tricks) {
   }
 }
 
+TEST(Solver, current_trick) {
+  // Searches from the middle of a trick, whose cutoffs by the decided current
+  // trick are counted from the trace.
+  int cutoffs = 0;
+  for (int seed = 0; seed < 100; seed++) {
+    Game              g = Random(seed).random_game(DEAL_SIZE);
+    std::vector<Card> trick;
+    for (int i = 0; i <= seed % 3; i++) {
+      Cards plays = g.valid_plays_all();
+      Card  c     = seed % 2 ? plays.highest() : plays.lowest();
+      trick.push_back(c);
+      g.play(c);
+    }
+    Game root(g.trump_suit(), g.lead_seat(), g.hands(), trick);
+
+    std::stringstream trace;
+    Solver            s1(root);
+    Solver            s2(root);
+    s1.enable_tracing(&trace);
+    s2.enable_fast_tricks(false);
+    auto r1 = s1.solve();
+    auto r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns) << "seed " << seed;
+
+    int seed_cutoffs = 0;
+    for (std::string line; std::getline(trace, line);) {
+      if (line.find(" ct_cutoff ") != std::string::npos) {
+        seed_cutoffs++;
+      }
+    }
+    if constexpr (SearchCounters::ENABLED) {
+      int64_t counted = 0;
+      for (const auto &by_position : s1.stats().search_counters.depths) {
+        for (const SearchCounters::Depth &depth : by_position) {
+          counted += depth.ct_cutoffs;
+        }
+      }
+      ASSERT_EQ(counted, seed_cutoffs) << "seed " << seed;
+    }
+    cutoffs += seed_cutoffs;
+  }
+  EXPECT_GT(cutoffs, 0);
+}
+
+TEST(Solver, play_history) {
+  for (int seed = 0; seed < 100; seed++) {
+    Game   g = Random(seed).random_game(DEAL_SIZE);
+    Solver s = Solver(g);
+    s.enable_all_optimizations(true);
+    s.enable_play_history(true);
+    ASSERT_NO_FATAL_FAILURE({
+      SCOPED_TRACE(::testing::Message() << "seed " << seed);
+      validate_solver(s);
+    });
+  }
+}
+
 TEST(Solver, all_optimizations) {
   for (int seed = 0; seed < 100; seed++) {
     Game   g = Random(seed).random_game(DEAL_SIZE);
@@ -78,6 +136,114 @@ TEST(Solver, all_optimizations) {
   }
 }
 
+TEST(Solver, reset) {
+  Solver s(Random(0).random_game(DEAL_SIZE));
+  for (int seed = 1; seed < 100; seed++) {
+    Game g = Random(seed).random_game(DEAL_SIZE);
+    s.reset(g, seed % 2 ? Solver::KEEP_TPN_TABLE : Solver::CLEAR_TPN_TABLE);
+    auto r1 = s.solve();
+    auto r2 = Solver(g).solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns) << "seed " << seed;
+  }
+}
+
+TEST(Solver, reset_clears_tpn_table) {
+  Solver s(Random(0).random_game(DEAL_SIZE));
+  s.solve();
+  ASSERT_GT(s.stats().tpn_table_stats.entries, 0);
+  s.reset(Random(1).random_game(DEAL_SIZE));
+  auto stats = s.stats();
+  ASSERT_EQ(stats.nodes_explored, 0);
+  ASSERT_EQ(stats.tpn_table_stats.buckets, 0);
+  ASSERT_EQ(stats.tpn_table_stats.entries, 0);
+  ASSERT_GT(stats.tpn_table_stats.bytes, 0);
+}
+
+static SearchCounters::Depth total_counters(const SearchCounters &counters) {
+  SearchCounters::Depth total;
+  for (const auto &by_position : counters.depths) {
+    for (const SearchCounters::Depth &depth : by_position) {
+      total.add(depth);
+    }
+  }
+  return total;
+}
+
+TEST(Solver, search_counters) {
+  Solver s(Random(1).random_game(DEAL_SIZE));
+  s.solve();
+  auto stats = s.stats();
+  auto total = total_counters(stats.search_counters);
+  if constexpr (!SearchCounters::ENABLED) {
+    EXPECT_TRUE(total.empty());
+    return;
+  }
+
+  EXPECT_EQ(total.nodes, stats.nodes_explored);
+  EXPECT_GE(total.plays, total.nodes);
+  EXPECT_GT(total.terminals, 0);
+  EXPECT_GT(total.tpn_inserts, 0);
+  EXPECT_EQ(stats.search_counters.depths[0][0].terminals, total.terminals);
+  // The table and fast tricks are only used at the start of a trick, and the
+  // current trick decides cutoffs only in the middle of one.
+  for (const auto &by_position : stats.search_counters.depths) {
+    EXPECT_EQ(by_position[0].ct_cutoffs, 0);
+    for (int pos = 1; pos < 4; pos++) {
+      EXPECT_EQ(by_position[pos].tpn_lookups, 0);
+      EXPECT_EQ(by_position[pos].ft_cutoffs, 0);
+    }
+  }
+  EXPECT_GT(total.ct_cutoffs, 0);
+
+  s.reset(Random(2).random_game(DEAL_SIZE));
+  EXPECT_TRUE(total_counters(s.stats().search_counters).empty());
+}
+
+TEST(Solver, solve_all_plays) {
+  for (int seed = 0; seed < 100; seed++) {
+    Game                            g = Random(seed).random_game(DEAL_SIZE);
+    std::vector<Solver::PlayResult> plays;
+    auto r = Solver(g).solve_all_plays(plays);
+    ASSERT_EQ(r.tricks_taken_by_ns, Solver(g).solve().tricks_taken_by_ns);
+    ASSERT_EQ(plays.size(), size_t(g.valid_plays_all().count()));
+    for (const auto &p : plays) {
+      g.play(p.card);
+      auto expected = Solver(g).solve();
+      g.unplay();
+      ASSERT_EQ(p.tricks_taken_by_ns, expected.tricks_taken_by_ns)
+          << std::format("seed {} card {}", seed, p.card);
+    }
+  }
+}
+
+TEST(Solver, solve_replay) {
+  for (int seed = 0; seed < 100; seed++) {
+    Game              g = Random(seed).random_game(DEAL_SIZE);
+    std::vector<Card> plays;
+    for (Game h = g; !h.finished(); h.play(plays.back())) {
+      plays.push_back(*h.valid_plays_all().low_to_high().begin());
+    }
+
+    auto results = Solver(g).solve_replay(plays);
+    ASSERT_EQ(results.size(), plays.size() + 1);
+    for (size_t i = 0; i < results.size(); i++) {
+      Solver s(g);
+      s.enable_all_optimizations(false);
+      auto expected = s.solve();
+      ASSERT_EQ(results[i].tricks_taken_by_ns, expected.tricks_taken_by_ns)
+          << std::format("seed {} play {}", seed, i);
+      if (i < plays.size()) {
+        g.play(plays[i]);
+      }
+    }
+  }
+}
+
+TEST(Solver, solve_replay_invalid_play) {
+  Solver s(Game(HEARTS, WEST, Hands("A2.../93.../5.2../6.3..")));
+  EXPECT_THROW(s.solve_replay({Card("2S"), Card("2H")}), std::runtime_error);
+}
+
 struct ManualTestCase {
   const char *name;
   Hands       hands;
@@ -95,6 +261,14 @@ TEST_P(ManualTest, manual_test) {
   Solver                s(g);
   auto                  r = s.solve();
   EXPECT_EQ(r.tricks_taken_by_ns, p.tricks_taken_by_ns);
+
+  std::vector<Solver::PlayResult> plays;
+  s.solve_all_plays(plays);
+  for (const auto &play : plays) {
+    if (p.best_plays.contains(play.card)) {
+      EXPECT_EQ(play.tricks_taken_by_ns, p.tricks_taken_by_ns);
+    }
+  }
 }
 
 const ManualTestCase MANUAL_TESTS[] = {
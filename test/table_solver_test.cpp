@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "random.h"
+#include "table_solver.h"
+
+void validate_table(const Hands &hands, const TableSolver::Result &result) {
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat declarer = FIRST_SEAT; declarer <= LAST_SEAT; declarer++) {
+      Solver solver(Game(strain, right_seat(declarer), hands));
+      auto   r  = solver.solve();
+      bool   ns = declarer == NORTH || declarer == SOUTH;
+      ASSERT_EQ(
+          result.tricks(strain, declarer),
+          ns ? r.tricks_taken_by_ns : r.tricks_taken_by_ew
+      );
+    }
+  }
+}
+
+TEST(TableSolver, random) {
+  for (int seed = 0; seed < 20; seed++) {
+    Hands       hands = Random(seed).random_deal(5);
+    TableSolver solver(hands);
+    auto        result = solver.solve();
+    ASSERT_NO_FATAL_FAILURE({
+      SCOPED_TRACE(::testing::Message() << "seed " << seed);
+      validate_table(hands, result);
+    });
+  }
+}
+
+TEST(TableSolver, threads) {
+  for (int seed = 0; seed < 20; seed++) {
+    Hands       hands = Random(seed).random_deal(5);
+    TableSolver solver(hands);
+    solver.enable_threads(5);
+    auto result = solver.solve();
+    ASSERT_NO_FATAL_FAILURE({
+      SCOPED_TRACE(::testing::Message() << "seed " << seed);
+      validate_table(hands, result);
+    });
+  }
+}
+
+TEST(TableSolver, format) {
+  TableSolver::Result result;
+  for (Suit strain = FIRST_SUIT; strain <= NO_TRUMP; strain++) {
+    for (Seat seat = FIRST_SEAT; seat <= LAST_SEAT; seat++) {
+      result.set_tricks(strain, seat, seat == NORTH ? 13 : seat);
+    }
+  }
+  EXPECT_EQ(std::format("{}", result), "0d23.0d23.0d23.0d23.0d23");
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#include "thread_pool.h"
+
+TEST(ThreadPool, run_all) {
+  ThreadPool            pool(3);
+  ThreadPool::TaskGroup group;
+  std::atomic<int>      count = 0;
+  for (int i = 0; i < 1000; i++) {
+    pool.run(group, [&count]() { count++; });
+  }
+  pool.wait(group);
+  ASSERT_EQ(count, 1000);
+}
+
+TEST(ThreadPool, no_workers) {
+  ThreadPool            pool(0);
+  ThreadPool::TaskGroup group;
+  int                   count = 0;
+  for (int i = 0; i < 10; i++) {
+    pool.run(group, [&count]() { count++; });
+  }
+  pool.wait(group);
+  ASSERT_EQ(count, 10);
+}
+
+TEST(ThreadPool, nested) {
+  ThreadPool            pool(2);
+  ThreadPool::TaskGroup group;
+  std::atomic<int>      count = 0;
+  for (int i = 0; i < 10; i++) {
+    pool.run(group, [&pool, &count]() {
+      ThreadPool::TaskGroup nested;
+      for (int j = 0; j < 10; j++) {
+        pool.run(nested, [&count]() { count++; });
+      }
+      pool.wait(nested);
+    });
+  }
+  pool.wait(group);
+  ASSERT_EQ(count, 100);
+}
+
+#ifndef _WIN32
+static double thread_cpu_ms() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+TEST(ThreadPool, wait_sleeps) {
+  // The waiting thread has nothing to steal while the worker runs the task,
+  // so should sleep rather than spin.
+  ThreadPool            pool(1);
+  ThreadPool::TaskGroup group;
+  pool.run(group, []() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  double begin = thread_cpu_ms();
+  pool.wait(group);
+  EXPECT_LT(thread_cpu_ms() - begin, 50);
+}
+#endif
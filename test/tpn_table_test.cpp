@@ -2,6 +2,8 @@
 #include <gtest/gtest.h>
 
 #include "random.h"
+#include "smp_solver.h"
+#include "solver.h"
 #include "tpn_table.h"
 
 using ::testing::ElementsAre;
@@ -81,8 +83,10 @@ Hands random_partition(Random &random, int cards_per_hand) {
 TEST(TpnBucket, random) {
   Random random(123);
 
-  TpnBucket      bucket1;
-  NaiveTpnBucket bucket2;
+  TpnBucket::Arena arena;
+  TpnBucket        bucket1(arena);
+  NaiveTpnBucket   bucket2;
+  TpnBucket::Stats stats;
 
   for (int i = 0; i < 500; i++) {
     Hands partition = random_partition(random, 3);
@@ -97,7 +101,7 @@ TEST(TpnBucket, random) {
       upper_bound = std::max(upper_bound - 1, lower_bound);
     }
 
-    bucket1.insert(partition, lower_bound, upper_bound);
+    bucket1.insert(partition, lower_bound, upper_bound, stats);
     bucket2.insert(partition, lower_bound, upper_bound);
   }
 
@@ -110,7 +114,7 @@ TEST(TpnBucket, random) {
       int   beta  = j + 1;
       int   score1, score2;
       Cards wbr1, wbr2;
-      bool  found1 = bucket1.lookup(hands, alpha, beta, score1, wbr1);
+      bool  found1 = bucket1.lookup(hands, alpha, beta, score1, wbr1, stats);
       bool  found2 = bucket2.lookup(hands, alpha, beta, score2, wbr2);
       ASSERT_EQ(found1, found2);
       if (score2 <= alpha) {
@@ -124,3 +128,90 @@ TEST(TpnBucket, random) {
     }
   }
 }
+
+TEST(TpnBucket, best_play) {
+  TpnBucket::Arena arena;
+  TpnBucket        bucket(arena);
+  TpnBucket::Stats stats;
+
+  Hands hands("AK.../QJ.../T9.../87...");
+  Hands general = hands.make_partition(Cards({"AS"}));
+  bucket.insert(general, 0, 2, stats, Card("KS").index());
+
+  int   score, best_play;
+  Cards wbr;
+  ASSERT_FALSE(bucket.lookup(hands, 0, 1, score, wbr, stats, &best_play));
+  EXPECT_EQ(best_play, Card("KS").index());
+
+  // The more specific entry's best play is preferred, and the best play of an
+  // existing entry is replaced.
+  bucket.insert(hands, 0, 1, stats, Card("AS").index());
+  ASSERT_FALSE(bucket.lookup(hands, 0, 1, score, wbr, stats, &best_play));
+  EXPECT_EQ(best_play, Card("AS").index());
+  bucket.insert(hands, 0, 1, stats, Card("QS").index());
+  ASSERT_FALSE(bucket.lookup(hands, 0, 1, score, wbr, stats, &best_play));
+  EXPECT_EQ(best_play, Card("QS").index());
+
+  // Entries may be stored without a best play.
+  TpnBucket bucket2(arena);
+  bucket2.insert(general, 0, 2, stats);
+  ASSERT_FALSE(bucket2.lookup(hands, 0, 1, score, wbr, stats, &best_play));
+  EXPECT_EQ(best_play, TpnBucket::NO_PLAY);
+  bucket.check_invariants();
+}
+
+TEST(TpnBucketKey, game) {
+  for (int seed = 0; seed < 20; seed++) {
+    Game                      g = Random(seed).random_game(13);
+    std::vector<TpnBucketKey> keys;
+    while (!g.finished()) {
+      if (g.start_of_trick()) {
+        TpnBucketKey key(g.next_seat(), g.normalized_hands());
+        ASSERT_EQ(TpnBucketKey(g), key) << "seed " << seed;
+        keys.push_back(key);
+      }
+      g.play(g.valid_plays_all().lowest());
+    }
+    // The key is restored as the cards are unplayed.
+    while (g.started()) {
+      g.unplay();
+      if (g.start_of_trick()) {
+        ASSERT_EQ(TpnBucketKey(g), keys.back()) << "seed " << seed;
+        keys.pop_back();
+      }
+    }
+  }
+}
+
+TEST(TpnTable, memory_budget) {
+  const int64_t MAX_BYTES = TpnTable().min_memory_budget();
+  int64_t       evicted   = 0;
+  for (int seed = 0; seed < 20; seed++) {
+    Game   g = Random(seed).random_game(9);
+    Solver s1(g);
+    Solver s2(g);
+    s1.tpn_table().enable_memory_budget(MAX_BYTES);
+    auto r1 = s1.solve();
+    auto r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns) << "seed " << seed;
+    auto stats = s1.stats().tpn_table_stats;
+    ASSERT_LE(stats.bytes, MAX_BYTES) << "seed " << seed;
+    evicted += stats.evicted_buckets;
+  }
+  ASSERT_GT(evicted, 0);
+}
+
+TEST(TpnTable, memory_budget_minimum) {
+  // Split between the shards of a concurrent table, this budget is smaller
+  // than an arena chunk, so is raised to the minimum.
+  for (int seed = 0; seed < 5; seed++) {
+    Game      g = Random(seed).random_game(7);
+    SmpSolver s1(g, 2);
+    Solver    s2(g);
+    s1.tpn_table().enable_memory_budget(1 << 20);
+    auto r1 = s1.solve();
+    auto r2 = s2.solve();
+    ASSERT_EQ(r1.tricks_taken_by_ns, r2.tricks_taken_by_ns) << "seed " << seed;
+    ASSERT_GT(s1.stats().tpn_table_stats.entries, 0) << "seed " << seed;
+  }
+}